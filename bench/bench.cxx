@@ -0,0 +1,1009 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: bench.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the headers of STL.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <unistd.h>
+
+// Include custom headers.
+#include "arguments.hxx"
+#include "catalog.hxx"
+#include "complete.hxx"
+#include "config.hxx"
+#include "files.hxx"
+#include "headless.hxx"
+#include "stats.hxx"
+#include "trigram.hxx"
+#include "window.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Number of queries measured by the trigram benchmark.
+#define BENCH_N_QUERIES (1000)
+
+// Seed of the pseudo random numbers, fixed so that the results are comparable across runs.
+#define BENCH_SEED (20240601)
+
+// Number of candidates read by "get()" after each keystroke (same as the window).
+#define BENCH_N_CANDIDATES (8)
+
+// Maximum length of the generated keystroke sessions.
+#define BENCH_MAX_SESSION (8)
+
+// Timeout of waiting for the window to present the expected contents [usec].
+#define BENCH_FRAME_TIMEOUT (5000000)
+
+// Key code of the escape key which closes the window.
+#define BENCH_ESCAPE (27)
+
+// Expected texts of the lines of the window.
+#define BENCH_LABEL_COMMAND   ("Command  : ")
+#define BENCH_LABEL_CANDIDATE ("Candidate: ")
+#define BENCH_NOT_FOUND       ("Command not found")
+
+// Token of the backspace in the keystroke file, and the key code of it.
+#define BENCH_BACKSPACE_TOKEN "\\b"
+#define BENCH_BACKSPACE       (8)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    size_t      n_names;   // Number of command names.
+    size_t      n_dirs;    // Number of directories in "PATH".
+    size_t      sessions;  // Number of generated keystroke sessions.
+    std::string dist;      // Distribution of the command names.
+    std::string mode;      // Matching mode.
+    std::string keys;      // Path to the keystroke file (generated if empty).
+    std::string stats;     // Path to the latency statistics file (disabled if empty).
+    bool        trigram;   // True if the trigram index is enabled.
+    int32_t     threads;   // Number of matching threads (0: all cores).
+    uint32_t    seed;      // Seed of the pseudo random numbers.
+}
+BenchOptions;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static double
+elapsed_usec(const std::chrono::steady_clock::time_point& start) noexcept
+// [Abstract]
+//   Returns the elapsed time from the given time point in micro seconds.
+//
+// [Args]
+//   start (const std::chrono::steady_clock::time_point&): [IN] Start time.
+//
+// [Returns]
+//   (double): Elapsed time [usec].
+//
+{   // {{{
+
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+}   // }}}
+
+static double
+percentile(std::vector<double> values, const double ratio) noexcept
+// [Abstract]
+//   Returns the given percentile of the values by the nearest rank method.
+//
+// [Args]
+//   values (std::vector<double>): [IN] Measured values (copied for sorting).
+//   ratio  (const double)       : [IN] Percentile in [0, 1].
+//
+// [Returns]
+//   (double): Percentile value, or zero if no value is given.
+//
+{   // {{{
+
+    if (values.empty())
+        return 0.0;
+
+    const size_t rank = static_cast<size_t>(std::ceil(ratio * values.size()));
+    const size_t nth  = std::min(std::max<size_t>(rank, 1), values.size()) - 1;
+
+    std::nth_element(values.begin(), values.begin() + nth, values.end());
+
+    return values[nth];
+
+}   // }}}
+
+static void
+reset_peak_rss(void) noexcept
+// [Abstract]
+//   Reset the peak resident set size of this process so that the following phase is measured
+//   without the memory used for the preparation. Nothing happens if the kernel does not support.
+//
+{   // {{{
+
+    std::ofstream file("/proc/self/clear_refs");
+    file << "5" << std::flush;
+
+}   // }}}
+
+static int64_t
+peak_rss_kb(void) noexcept
+// [Abstract]
+//   Returns the peak resident set size of this process.
+//
+// [Returns]
+//   (int64_t): Peak resident set size [KB], or -1 if unknown.
+//
+{   // {{{
+
+    std::ifstream file("/proc/self/status");
+    std::string   line;
+
+    while (std::getline(file, line))
+        if (line.rfind("VmHWM:", 0) == 0)
+            return std::atoll(line.c_str() + 6);
+
+    return -1;
+
+}   // }}}
+
+static std::vector<std::string>
+read_names(std::istream& stream) noexcept
+// [Abstract]
+//   Read the lines of the given stream as names sorted without duplication.
+//
+// [Args]
+//   stream (std::istream&): [IN] Input stream.
+//
+// [Returns]
+//   (std::vector<std::string>): Sorted names.
+//
+{   // {{{
+
+    std::vector<std::string> names;
+    std::string              line;
+
+    while (std::getline(stream, line))
+        if (not line.empty())
+            names.push_back(line);
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+
+    return names;
+
+}   // }}}
+
+static std::vector<std::string>
+make_names(const BenchOptions& options, std::mt19937& rng) noexcept
+// [Abstract]
+//   Generate distinct command names of the given distribution.
+//     - "words"   : 1 to 3 words joined by '-' where the words follow the Zipf distribution,
+//                   like "gnome-session-properties". A number is appended to keep them distinct.
+//     - "random"  : random strings of 3 to 20 characters of [a-z0-9_-].
+//     - "prefixed": names sharing long prefixes, like "x86_64-linux-gnu-gcc-12".
+//     - "utf8"    : same as "words" but half of the words have non-ASCII characters which share
+//                   the leading bytes, like "café-crème" and "cafè-crêpe".
+//
+// [Args]
+//   options (const BenchOptions&): [IN]     Benchmark options.
+//   rng     (std::mt19937&)      : [IN/OUT] Pseudo random number generator.
+//
+// [Returns]
+//   (std::vector<std::string>): Generated names (not sorted).
+//
+{   // {{{
+
+    static const char* WORDS[] = {
+        "x", "lib", "git", "gnome", "kde", "python", "perl", "gtk", "qt", "xdg", "config", "session",
+        "update", "get", "set", "list", "daemon", "manager", "tool", "ctl", "dump", "info", "test",
+        "make", "build", "run", "view", "edit", "open", "mime", "font", "print", "net", "db", "ssh",
+        "sys", "user", "file", "text", "image", "audio", "video", "cache", "key", "mount", "pkg",
+    };
+    static const char* PREFIXES[] = {
+        "x86_64-linux-gnu-", "aarch64-linux-gnu-", "arm-none-eabi-", "llvm-", "gnome-", "kde-",
+        "git-", "systemd-", "python3-", "perl5.36-",
+    };
+    static const char* UTF8_WORDS[] = {
+        "caf\u00e9", "caf\u00e8", "cr\u00e8me", "cr\u00eape", "na\u00efve", "\u00fcber", "\u00fbber",
+        "se\u00f1or", "d\u00e9j\u00e0", "fa\u00e7ade", "\u65e5\u672c", "\u65e5\u5f0f", "\U0001f600", "\U0001f601",
+    };
+    static const char CHARS[] = "abcdefghijklmnopqrstuvwxyz0123456789_-";
+
+    const size_t n_words = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    // Zipf distribution of the words with the exponent 1.
+    std::vector<double> weights;
+    for (size_t idx = 0; idx < n_words; ++idx)
+        weights.push_back(1.0 / (idx + 1));
+
+    std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+    std::set<std::string>              names;
+
+    while (names.size() < options.n_names)
+    {
+        std::string name;
+
+        if (options.dist == "random")
+        {
+            const size_t length = 3 + rng() % 18;
+            for (size_t idx = 0; idx < length; ++idx)
+                name += CHARS[rng() % (sizeof(CHARS) - 1)];
+        }
+        else if (options.dist == "prefixed")
+        {
+            name = std::string(PREFIXES[rng() % (sizeof(PREFIXES) / sizeof(PREFIXES[0]))]) + WORDS[zipf(rng)];
+            if (rng() % 2) name.append("-").append(std::to_string(rng() % 100));
+        }
+        else if (options.dist == "utf8")
+        {
+            const size_t n_parts = 1 + rng() % 3;
+            for (size_t idx = 0; idx < n_parts; ++idx)
+                name.append((idx == 0) ? "" : "-").append((rng() % 2) ? UTF8_WORDS[rng() % (sizeof(UTF8_WORDS) / sizeof(UTF8_WORDS[0]))] : WORDS[zipf(rng)]);
+        }
+        else
+        {
+            const size_t n_parts = 1 + rng() % 3;
+            for (size_t idx = 0; idx < n_parts; ++idx)
+                name.append((idx == 0) ? "" : "-").append(WORDS[zipf(rng)]);
+        }
+
+        // Make the name distinct if it is already used.
+        if (names.count(name) > 0)
+            name += std::to_string(rng() % (options.n_names + 1));
+
+        names.insert(name);
+    }
+
+    std::vector<std::string> result(names.begin(), names.end());
+    std::shuffle(result.begin(), result.end(), rng);
+
+    return result;
+
+}   // }}}
+
+static bool
+make_path_tree(const std::filesystem::path& root, const std::vector<std::string>& names, const size_t n_dirs) noexcept
+// [Abstract]
+//   Create the directories "bin0", "bin1", ... in the given directory, and distribute the given
+//   names to them as empty executable files.
+//
+// [Args]
+//   root   (const std::filesystem::path&)   : [IN] Root directory.
+//   names  (const std::vector<std::string>&): [IN] Command names.
+//   n_dirs (const size_t)                   : [IN] Number of directories.
+//
+// [Returns]
+//   (bool): False if failed.
+//
+{   // {{{
+
+    std::error_code ec;
+
+    for (size_t dir = 0; dir < n_dirs; ++dir)
+        if (not std::filesystem::create_directories(root / ("bin" + std::to_string(dir)), ec) and ec)
+            return false;
+
+    for (size_t idx = 0; idx < names.size(); ++idx)
+    {
+        const std::string path = (root / ("bin" + std::to_string(idx % n_dirs)) / names[idx]).string();
+        const int32_t     fd   = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0755);
+
+        if (fd < 0)
+            return false;
+
+        close(fd);
+    }
+
+    return true;
+
+}   // }}}
+
+static std::vector<std::string>
+make_sessions(const BenchOptions& options, const std::vector<std::string>& names, std::mt19937& rng) noexcept
+// [Abstract]
+//   Generate keystroke sessions that find random names in the given matching mode. A session is
+//   a prefix of the name in the prefix mode, a substring in the substring mode, and a subsequence
+//   in the fuzzy mode, of at most BENCH_MAX_SESSION characters. The non-ASCII bytes are removed
+//   because they cannot be typed.
+//
+// [Args]
+//   options (const BenchOptions&)            : [IN]     Benchmark options.
+//   names   (const std::vector<std::string>&): [IN]     Command names.
+//   rng     (std::mt19937&)                  : [IN/OUT] Pseudo random number generator.
+//
+// [Returns]
+//   (std::vector<std::string>): Keystroke sessions.
+//
+{   // {{{
+
+    std::vector<std::string> sessions;
+
+    while (sessions.size() < options.sessions)
+    {
+        const std::string& name   = names[rng() % names.size()];
+        const size_t       length = std::min<size_t>(name.size(), 1 + rng() % BENCH_MAX_SESSION);
+
+        if (options.mode == "fuzzy")
+        {
+            std::vector<size_t> positions(name.size());
+            for (size_t idx = 0; idx < name.size(); ++idx)
+                positions[idx] = idx;
+
+            std::shuffle(positions.begin(), positions.end(), rng);
+            positions.resize(length);
+            std::sort(positions.begin(), positions.end());
+
+            std::string session;
+            for (const size_t pos : positions)
+                session += name[pos];
+
+            sessions.push_back(session);
+        }
+        else if (options.mode == "substring")
+        {
+            sessions.push_back(name.substr(rng() % (name.size() - length + 1), length));
+        }
+        else
+        {
+            sessions.push_back(name.substr(0, length));
+        }
+
+        std::string& session = sessions.back();
+        session.erase(std::remove_if(session.begin(), session.end(), [](const char c) { return static_cast<uint8_t>(c) >= 0x80; }), session.end());
+    }
+
+    return sessions;
+
+}   // }}}
+
+static bool
+parse_options(int32_t argc, char* argv[], BenchOptions& options) noexcept
+// [Abstract]
+//   Parse the options of the complete benchmark.
+//
+// [Args]
+//   argc    (int32_t)      : [IN]  Number of arguments.
+//   argv    (char*[])      : [IN]  Arguments following the benchmark name.
+//   options (BenchOptions&): [OUT] Parsed options.
+//
+// [Returns]
+//   (bool): False if an unknown option is given.
+//
+{   // {{{
+
+    options = {10000, 8, 200, "words", "prefix", "", "", false, 0, BENCH_SEED};
+
+    for (int32_t idx = 0; idx + 1 < argc; idx += 2)
+    {
+        const std::string key   = argv[idx];
+        const char*       value = argv[idx + 1];
+
+        if      (key == "--names"   ) options.n_names  = std::max(std::strtoull(value, nullptr, 10), 1ull);
+        else if (key == "--dirs"    ) options.n_dirs   = std::max(std::strtoull(value, nullptr, 10), 1ull);
+        else if (key == "--sessions") options.sessions = std::strtoull(value, nullptr, 10);
+        else if (key == "--dist"    ) options.dist     = value;
+        else if (key == "--mode"    ) options.mode     = value;
+        else if (key == "--keys"    ) options.keys     = value;
+        else if (key == "--stats"   ) options.stats    = value;
+        else if (key == "--trigram" ) options.trigram  = (std::strcmp(value, "0") != 0);
+        else if (key == "--threads" ) options.threads  = std::atoi(value);
+        else if (key == "--seed"    ) options.seed     = std::strtoul(value, nullptr, 10);
+        else                          return false;
+    }
+
+    return (argc % 2 == 0);
+
+}   // }}}
+
+static std::string
+decode_keys(const std::string& line) noexcept
+// [Abstract]
+//   Convert a line of the keystroke file to the key codes. The token BENCH_BACKSPACE_TOKEN is
+//   converted to BENCH_BACKSPACE.
+//
+// [Args]
+//   line (const std::string&): [IN] Line of the keystroke file.
+//
+// [Returns]
+//   (std::string): Key codes.
+//
+{   // {{{
+
+    const size_t token = std::strlen(BENCH_BACKSPACE_TOKEN);
+    std::string  keys;
+
+    for (size_t pos = 0; pos < line.size(); ++pos)
+    {
+        if (line.compare(pos, token, BENCH_BACKSPACE_TOKEN) == 0)
+        {
+            keys.push_back(BENCH_BACKSPACE);
+            pos += token - 1;
+        }
+        else
+        {
+            keys.push_back(line[pos]);
+        }
+    }
+
+    return keys;
+
+}   // }}}
+
+static bool
+prepare_bench(const BenchOptions& options, std::filesystem::path& root, std::vector<std::string>& names, std::vector<std::string>& sessions) noexcept
+// [Abstract]
+//   Create the synthetic "PATH" tree in a temporary directory, point "PATH" and the XDG
+//   directories of the cache and the history to it, and load the default config values except
+//   for the given options. The temporary directory should be removed by the caller.
+//
+// [Args]
+//   options  (const BenchOptions&)      : [IN]  Benchmark options.
+//   root     (std::filesystem::path&)   : [OUT] Temporary directory.
+//   names    (std::vector<std::string>&): [OUT] Command names.
+//   sessions (std::vector<std::string>&): [OUT] Key codes of each keystroke session.
+//
+// [Returns]
+//   (bool): False if failed.
+//
+{   // {{{
+
+    // Create the temporary directory where the PATH tree, the cache and the history are stored.
+    char templ[] = "/tmp/hiruge-bench.XXXXXX";
+    if (mkdtemp(templ) == nullptr)
+    {
+        std::cerr << "HiRuGe: Cannot create a temporary directory" << std::endl;
+        return false;
+    }
+
+    std::mt19937 rng(options.seed);
+
+    root  = templ;
+    names = make_names(options, rng);
+
+    if (not make_path_tree(root, names, options.n_dirs))
+    {
+        std::cerr << "HiRuGe: Cannot create the PATH tree in " << root << std::endl;
+        std::filesystem::remove_all(root);
+        return false;
+    }
+
+    std::string path;
+    for (size_t dir = 0; dir < options.n_dirs; ++dir)
+        path.append((dir == 0) ? "" : ":").append((root / ("bin" + std::to_string(dir))).string());
+
+    setenv("PATH",           path.c_str(),             1);
+    setenv("XDG_CACHE_HOME", (root / "cache").c_str(), 1);
+    setenv("XDG_DATA_HOME",  (root / "data").c_str(),  1);
+
+    // Use the default config values except for the given options.
+    const std::string config_path = (root / "config.toml").string();
+    std::ofstream(config_path).close();
+    load_config(config_path);
+
+    config.match_mode    = options.mode;
+    config.trigram_index = options.trigram;
+    config.match_threads = options.threads;
+
+    // Read or generate the keystroke sessions.
+    if (options.keys.empty())
+    {
+        sessions = make_sessions(options, names, rng);
+    }
+    else
+    {
+        std::ifstream file(options.keys);
+        std::string   line;
+
+        while (std::getline(file, line))
+            sessions.push_back(decode_keys(line));
+    }
+
+    return true;
+
+}   // }}}
+
+static int32_t
+bench_complete(int32_t argc, char* argv[]) noexcept
+// [Abstract]
+//   Measure the startup time and the per-keystroke latency of the "Complete" class with a
+//   synthetic "PATH" tree in a temporary directory. The startup is measured twice, without and
+//   with the command index cache. Each keystroke calls "update()" and then "get()" for the
+//   candidates shown in the window.
+//
+// [Args]
+//   argc (int32_t): [IN] Number of arguments.
+//   argv (char*[]): [IN] Arguments following the benchmark name.
+//
+// [Returns]
+//   (int32_t): Exit status.
+//
+{   // {{{
+
+    BenchOptions options;
+    if (not parse_options(argc, argv, options))
+    {
+        std::cerr << "HiRuGe: Invalid options" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path    root;
+    std::vector<std::string> names, sessions;
+    if (not prepare_bench(options, root, names, sessions))
+        return EXIT_FAILURE;
+
+    reset_peak_rss();
+
+    // The first load scans the directories and writes the index cache, and the second one reads it.
+    auto start = std::chrono::steady_clock::now();
+    { Complete complete; complete.load(); }
+    const double cold_us = elapsed_usec(start);
+
+    start = std::chrono::steady_clock::now();
+    Complete complete;
+    complete.load();
+    const double warm_us = elapsed_usec(start);
+
+    // Replay the keystrokes. Each session starts from the empty input.
+    std::vector<double> latencies;
+    size_t              n_found = 0;
+
+    for (const std::string& session : sessions)
+    {
+        std::string input;
+        complete.update(input);
+
+        for (const char key : session)
+        {
+            if (key == BENCH_BACKSPACE) { if (not input.empty()) input.pop_back(); }
+            else                        { input.push_back(key);                    }
+
+            start = std::chrono::steady_clock::now();
+
+            complete.update(input);
+            for (size_t idx = 0; idx < BENCH_N_CANDIDATES; ++idx)
+                n_found += not complete.get(idx, "").empty();
+
+            latencies.push_back(elapsed_usec(start));
+        }
+    }
+
+    const int64_t rss_kb = peak_rss_kb();
+
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+
+    // Print the result as a JSON line.
+    std::cout << "{\"bench\":\"complete\""
+              << ",\"mode\":\""         << options.mode << "\""
+              << ",\"dist\":\""         << options.dist << "\""
+              << ",\"names\":"          << names.size()
+              << ",\"dirs\":"           << options.n_dirs
+              << ",\"trigram\":"        << (options.trigram ? "true" : "false")
+              << ",\"threads\":"        << options.threads
+              << ",\"startup_cold_ms\":" << cold_us / 1000.0
+              << ",\"startup_warm_ms\":" << warm_us / 1000.0
+              << ",\"keystrokes\":"     << latencies.size()
+              << ",\"avg_candidates\":" << (latencies.empty() ? 0.0 : static_cast<double>(n_found) / latencies.size())
+              << ",\"p50_us\":"         << percentile(latencies, 0.50)
+              << ",\"p99_us\":"         << percentile(latencies, 0.99)
+              << ",\"max_us\":"         << percentile(latencies, 1.00)
+              << ",\"peak_rss_kb\":"    << rss_kb
+              << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+
+}   // }}}
+
+static int32_t
+bench_window(int32_t argc, char* argv[]) noexcept
+// [Abstract]
+//   Measure the end-to-end latency from a key event to the window contents with the headless
+//   backend. The "MainWindow" loop runs on another thread, and each key is sent after the window
+//   presents the expected contents of the previous key, which are computed by another "Complete"
+//   instance. The latency is the time until the expected contents are presented, and a key
+//   whose contents are not presented within BENCH_FRAME_TIMEOUT is counted as a mismatch. The
+//   remaining keys are not sent after the first mismatch, because the following contents are
+//   not comparable any more and each of them would wait for the timeout.
+//
+// [Args]
+//   argc (int32_t): [IN] Number of arguments.
+//   argv (char*[]): [IN] Arguments following the benchmark name.
+//
+// [Returns]
+//   (int32_t): Exit status (failure if any mismatch is found).
+//
+{   // {{{
+
+    BenchOptions options;
+    if (not parse_options(argc, argv, options))
+    {
+        std::cerr << "HiRuGe: Invalid options" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::filesystem::path    root;
+    std::vector<std::string> names, sessions;
+    if (not prepare_bench(options, root, names, sessions))
+        return EXIT_FAILURE;
+
+    // The latency statistics of the window are dumped at the end.
+    if (not options.stats.empty())
+        enable_latency_stats(options.stats);
+
+    // Reference instance that computes the expected candidates.
+    Complete reference;
+    reference.load();
+
+    // The texts beyond the right edge of the window are clipped.
+    const size_t columns = (config.window_width - config.text_left_margin + HEADLESS_GLYPH_WIDTH - 1) / HEADLESS_GLYPH_WIDTH;
+
+    const auto expect = [&](const std::string& input) -> std::vector<std::pair<int32_t, std::string>>
+    {
+        reference.update(input);
+        const std::string_view candidate = reference.get(0, BENCH_NOT_FOUND);
+
+        return {{config.text_top1_margin, HeadlessBackend::glyphs(BENCH_LABEL_COMMAND   + input).substr(0, columns)},
+                {config.text_top2_margin, HeadlessBackend::glyphs(BENCH_LABEL_CANDIDATE + std::string(candidate)).substr(0, columns)}};
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    Complete        complete;
+    HeadlessBackend backend;
+    MainWindow      window(complete, backend);
+
+    char        name[] = "hiruge";
+    char*       args[] = {name, nullptr};
+    std::thread loop([&window, &args](void) { window.start(1, args, false); });
+
+    // The first frame with the candidates of the empty input marks the end of the startup.
+    size_t n_mismatches = backend.wait_text(expect(""), BENCH_FRAME_TIMEOUT) ? 0 : 1;
+
+    const double startup_us = elapsed_usec(start);
+
+    std::vector<double> latencies;
+
+    for (const std::string& session : sessions)
+    {
+        if (n_mismatches > 0)
+            break;
+
+        std::string input;
+
+        for (const char key : session)
+        {
+            if (key == BENCH_BACKSPACE) { if (not input.empty()) input.pop_back(); }
+            else                        { input.push_back(key);                    }
+
+            const auto expected = expect(input);
+
+            start = std::chrono::steady_clock::now();
+            backend.push_key(key);
+
+            if (backend.wait_text(expected, BENCH_FRAME_TIMEOUT))
+            {
+                latencies.push_back(elapsed_usec(start));
+                continue;
+            }
+
+            n_mismatches += 1;
+            std::cerr << "HiRuGe: Mismatch after \"" << input << "\": \""
+                      << backend.text(config.text_top1_margin) << "\" / \""
+                      << backend.text(config.text_top2_margin) << "\"" << std::endl;
+            break;
+        }
+
+        // Clear the input for the next session.
+        for (size_t idx = 0; idx < input.size(); ++idx)
+            backend.push_key(BENCH_BACKSPACE);
+
+        n_mismatches += backend.wait_text(expect(""), BENCH_FRAME_TIMEOUT) ? 0 : 1;
+    }
+
+    backend.push_key(BENCH_ESCAPE);
+    loop.join();
+    dump_latency_stats();
+
+    const int64_t rss_kb = peak_rss_kb();
+
+    std::error_code ec;
+    std::filesystem::remove_all(root, ec);
+
+    // Print the result as a JSON line.
+    std::cout << "{\"bench\":\"window\""
+              << ",\"mode\":\""       << options.mode << "\""
+              << ",\"dist\":\""       << options.dist << "\""
+              << ",\"names\":"        << names.size()
+              << ",\"trigram\":"      << (options.trigram ? "true" : "false")
+              << ",\"threads\":"      << options.threads
+              << ",\"startup_ms\":"   << startup_us / 1000.0
+              << ",\"keystrokes\":"   << latencies.size()
+              << ",\"mismatches\":"   << n_mismatches
+              << ",\"p50_us\":"       << percentile(latencies, 0.50)
+              << ",\"p99_us\":"       << percentile(latencies, 0.99)
+              << ",\"max_us\":"       << percentile(latencies, 1.00)
+              << ",\"peak_rss_kb\":"  << rss_kb
+              << "}" << std::endl;
+
+    return (n_mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}   // }}}
+
+static int32_t
+bench_trigram(std::istream& stream) noexcept
+// [Abstract]
+//   Measure the build time, the size and the query latency of the trigram index, and the latency
+//   of the linear scan for the same queries. The queries are substrings of 3 to 8 characters
+//   taken from random names.
+//
+// [Args]
+//   stream (std::istream&): [IN] Input stream of the names.
+//
+// [Returns]
+//   (int32_t): Exit status.
+//
+{   // {{{
+
+    Catalog catalog;
+    catalog.merge(read_names(stream));
+
+    if (catalog.size() == 0)
+    {
+        std::cerr << "HiRuGe: No name is given" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Build the index.
+    TrigramIndex index;
+
+    const auto   start    = std::chrono::steady_clock::now();
+    index.build(catalog);
+    const double build_us = elapsed_usec(start);
+
+    // Make the queries in lower case.
+    std::mt19937             rng(BENCH_SEED);
+    std::vector<std::string> queries;
+
+    while (queries.size() < BENCH_N_QUERIES)
+    {
+        const uint32_t    name   = rng() % catalog.size();
+        const std::string lower(catalog.lower(name), catalog.name(name).size());
+        const size_t      length = 3 + rng() % 6;
+
+        if (lower.size() >= length)
+            queries.push_back(lower.substr(rng() % (lower.size() - length + 1), length));
+    }
+
+    // Measure the both methods with the same queries, and check that the results are the same.
+    std::vector<double>   index_us, scan_us;
+    std::vector<uint32_t> found, scanned;
+    size_t                n_matches = 0;
+
+    for (const std::string& query : queries)
+    {
+        auto time = std::chrono::steady_clock::now();
+        index.search(catalog, query, found);
+        index_us.push_back(elapsed_usec(time));
+
+        time = std::chrono::steady_clock::now();
+        scanned.clear();
+        for (uint32_t idx = 0; idx < catalog.size(); ++idx)
+            if (memmem(catalog.lower(idx), catalog.name(idx).size(), query.data(), query.size()) != nullptr)
+                scanned.push_back(idx);
+        scan_us.push_back(elapsed_usec(time));
+
+        if (found != scanned)
+        {
+            std::cerr << "HiRuGe: Result mismatch: " << query << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        n_matches += found.size();
+    }
+
+    // Print the result as a JSON line.
+    std::cout << "{\"bench\":\"trigram\""
+              << ",\"names\":"         << catalog.size()
+              << ",\"build_ms\":"      << build_us / 1000.0
+              << ",\"index_bytes\":"   << index.bytes()
+              << ",\"queries\":"       << queries.size()
+              << ",\"avg_matches\":"   << static_cast<double>(n_matches) / queries.size()
+              << ",\"index_p50_us\":"  << percentile(index_us, 0.50)
+              << ",\"index_p99_us\":"  << percentile(index_us, 0.99)
+              << ",\"scan_p50_us\":"   << percentile(scan_us,  0.50)
+              << ",\"scan_p99_us\":"   << percentile(scan_us,  0.99)
+              << "}" << std::endl;
+
+    return EXIT_SUCCESS;
+
+}   // }}}
+
+static int32_t
+bench_providers(void) noexcept
+// [Abstract]
+//   Check the candidates of the providers on a fixed tree in a temporary directory: the command
+//   names in "PATH", an alias, the launched arguments and the files. The candidates of each input
+//   are compared with the expected ones in the same order, which checks the merge order of the
+//   providers (the earlier listed provider wins the ties) and the quoting of the completed paths.
+//   The providers are waited for each input as the batch query mode does.
+//
+// [Returns]
+//   (int32_t): Exit status.
+//
+{   // {{{
+
+    char templ[] = "/tmp/hiruge-bench.XXXXXX";
+    if (mkdtemp(templ) == nullptr)
+    {
+        std::cerr << "HiRuGe: Cannot create a temporary directory" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::filesystem::path root = templ;
+    const std::filesystem::path work = root / "work";
+
+    // The command names and the files typed as the arguments.
+    std::error_code ec;
+    std::filesystem::create_directories(work / "My Dir", ec);
+    std::filesystem::create_directories(work / "src",    ec);
+    for (const char* name : {"My Notes.txt", "a;b.txt", "café.txt", "src/main.cxx"})
+        std::ofstream(work / name).close();
+
+    if (ec or (not make_path_tree(root, {"gimp", "git", "grep"}, 1)))
+    {
+        std::cerr << "HiRuGe: Cannot create the tree in " << root << std::endl;
+        std::filesystem::remove_all(root, ec);
+        return EXIT_FAILURE;
+    }
+
+    setenv("PATH",           (root / "bin0").c_str(),  1);
+    setenv("HOME",           work.c_str(),             1);
+    setenv("XDG_CACHE_HOME", (root / "cache").c_str(), 1);
+    setenv("XDG_DATA_HOME",  (root / "data").c_str(),  1);
+    std::filesystem::current_path(work, ec);
+
+    const std::string config_path = (root / "config.toml").string();
+
+    // The arguments launched before. "status" is the most frequent one.
+    {
+        ArgumentHistory history;
+        for (const char* line : {"git status", "git stash", "git status", "git log"})
+            history.record(line);
+    }
+
+    // Expected candidates of each input for each order of the providers. The command names and
+    // the alias share one catalog, which is ordered by the name in the prefix mode.
+    const std::string files = "\"git My\\ Dir/\", \"git My\\ Notes.txt\", \"git a\\;b.txt\", \"git café.txt\", \"git src/\"";
+    const std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::string>>>> checks =
+    {
+        {"\"path\", \"alias\", \"args\", \"files\"",
+         {{"gi",         "\"gimp\", \"gist\", \"git\""},
+          {"git st",     "\"git status\", \"git stash\""},
+          {"git ",       "\"git status\", \"git stash\", \"git log\", " + files},
+          {"cat My",     "\"cat My\\ Dir/\", \"cat My\\ Notes.txt\""},
+          {"cat My\\ N", "\"cat My\\ Notes.txt\""},
+          {"cat 'My N",  "\"cat My\\ Notes.txt\""},
+          {"cat a",      "\"cat a\\;b.txt\""},
+          {"cat caf",    "\"cat café.txt\""},
+          {"cat src/",   "\"cat src/main.cxx\""},
+          {"cat ~/sr",   "\"cat ~/src/\""},
+          {"./s",        "\"./src/\""}}},
+        {"\"files\", \"args\", \"alias\"",
+         {{"gi",         "\"gist\""},
+          {"git ",       files + ", \"git status\", \"git stash\", \"git log\""}}},
+    };
+
+    size_t n_cases      = 0;
+    size_t n_mismatches = 0;
+
+    for (const auto& [enabled, cases] : checks)
+    {
+        std::ofstream(config_path) << "[PROVIDER]\n"
+                                   << "enabled = [" << enabled << "]\n"
+                                   << "[ALIAS]\n"
+                                   << "gist = \"git status\"\n";
+        load_config(config_path);
+        config.match_mode        = "prefix";
+        config.provider_deadline = -1;
+
+        Complete complete;
+        complete.add_provider("args",  std::make_unique<ArgumentProvider>(config));
+        complete.add_provider("files", std::make_unique<FileProvider>(config));
+        complete.load();
+
+        for (const auto& [input, expected] : cases)
+        {
+            complete.update(input);
+
+            std::string candidates;
+            for (size_t idx = 0; idx < complete.size(); ++idx)
+                candidates.append((idx == 0) ? "\"" : ", \"").append(complete.get(idx, "")).append("\"");
+
+            n_cases += 1;
+            if (candidates == expected)
+                continue;
+
+            n_mismatches += 1;
+            std::cerr << "HiRuGe: Mismatch for \"" << input << "\" with [" << enabled << "]: " << candidates << std::endl;
+        }
+    }
+
+    std::filesystem::remove_all(root, ec);
+
+    // Print the result as a JSON line.
+    std::cout << "{\"bench\":\"providers\""
+              << ",\"cases\":"      << n_cases
+              << ",\"mismatches\":" << n_mismatches
+              << "}" << std::endl;
+
+    return (n_mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Main function
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+main(int32_t argc, char *argv[])
+{   // {{{
+
+    // Usage: hiruge-bench complete [--names N] [--dirs N] [--dist words|random|prefixed]
+    //                              [--mode prefix|fuzzy|substring] [--trigram 0|1] [--threads N]
+    //                              [--sessions N] [--keys FILE] [--seed N]
+    if ((argc >= 2) and (std::strcmp(argv[1], "complete") == 0))
+        return bench_complete(argc - 2, argv + 2);
+
+    // Usage: hiruge-bench window [OPTIONS] [--stats FILE]
+    //   Same options as "complete". The latency statistics of the window are written to FILE.
+    if ((argc >= 2) and (std::strcmp(argv[1], "window") == 0))
+        return bench_window(argc - 2, argv + 2);
+
+    // Usage: hiruge-bench providers
+    //   Check the candidates of the providers on a fixed tree. No option is available.
+    if ((argc >= 2) and (std::strcmp(argv[1], "providers") == 0))
+        return bench_providers();
+
+    // Usage: hiruge-bench trigram [FILE]
+    //   The names are read from the given file or the standard input.
+    if ((argc >= 2) and (std::strcmp(argv[1], "trigram") == 0))
+    {
+        if (argc < 3)
+            return bench_trigram(std::cin);
+
+        std::ifstream file(argv[2]);
+        if (not file)
+        {
+            std::cerr << "HiRuGe: Cannot open " << argv[2] << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return bench_trigram(file);
+    }
+
+    std::cerr << "Usage: " << argv[0] << " complete [OPTIONS] | window [OPTIONS] | providers | trigram [FILE]" << std::endl;
+
+    return EXIT_FAILURE;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
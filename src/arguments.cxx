@@ -0,0 +1,390 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: arguments.cxx                                                               ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "arguments.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Include custom headers.
+#include "history.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Magic number at the head of the argument history file (8 bytes, includes format version).
+#define ARGUMENTS_MAGIC ("HRGARG01")
+
+// File name of the argument history.
+#define ARGUMENTS_FILENAME ("arguments.bin")
+
+// Number of the records in the argument history file.
+#define ARGUMENTS_MAX_RECORDS (1024)
+
+// Maximum number of the records of one command.
+#define ARGUMENTS_MAX_PER_COMMAND (32)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The argument history file is a header followed by ARGUMENTS_MAX_RECORDS fixed size records.
+// The file is created with all records, and the records are updated in place under the file lock.
+typedef struct
+{
+    char     magic[8];   // ARGUMENTS_MAGIC.
+    uint32_t n_records;  // Number of the records (ARGUMENTS_MAX_RECORDS).
+    uint32_t reserved;   // Zero.
+}
+ArgumentHeader;
+
+typedef struct
+{
+    int64_t  last;            // Time of the last launch (UNIX time), or zero if unused.
+    uint32_t count;           // Number of launches.
+    char     command[52];     // Command name padded by NUL.
+    char     arguments[192];  // Arguments padded by NUL.
+}
+ArgumentRecord;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string
+get_arguments_path(void) noexcept
+// [Abstract]
+//   Returns the path to the argument history file.
+//
+// [Returns]
+//   (std::string): "$XDG_DATA_HOME/hiruge/arguments.bin" or "~/.local/share/hiruge/arguments.bin".
+//
+{   // {{{
+
+    const char* xdg_data = std::getenv("XDG_DATA_HOME");
+    const char* home     = std::getenv("HOME");
+
+    std::filesystem::path root;
+    if      ((xdg_data != nullptr) and (xdg_data[0] != '\0')) root = std::filesystem::path(xdg_data);
+    else if (home != nullptr)                                 root = std::filesystem::path(home) / ".local" / "share";
+    else                                                      return std::string();
+
+    return (root / "hiruge" / ARGUMENTS_FILENAME).string();
+
+}   // }}}
+
+static bool
+split_command(const std::string& line, std::string& command, std::string& arguments) noexcept
+// [Abstract]
+//   Split the given command line into the command name (the first word) and the arguments
+//   without the surrounding spaces.
+//
+// [Args]
+//   line      (const std::string&): [IN]  Command line.
+//   command   (std::string&)      : [OUT] Command name.
+//   arguments (std::string&)      : [OUT] Arguments.
+//
+// [Returns]
+//   (bool): True if the command line has both of the command name and the arguments.
+//
+{   // {{{
+
+    const size_t space = line.find(' ');
+    if ((space == 0) or (space == std::string::npos))
+        return false;
+
+    const size_t first = line.find_first_not_of(' ', space);
+    if (first == std::string::npos)
+        return false;
+
+    command   = line.substr(0, space);
+    arguments = line.substr(first, line.find_last_not_of(' ') + 1 - first);
+
+    return true;
+
+}   // }}}
+
+static double
+frecency_score(const ArgumentRecord& record, const int64_t now) noexcept
+// [Abstract]
+//   Returns the frecency score of the given record. Only the time of the last launch is kept,
+//   therefore all launches are weighted by the age of the last one.
+//
+// [Args]
+//   record (const ArgumentRecord&): [IN] Record of the argument history.
+//   now    (const int64_t)        : [IN] Current time (UNIX time).
+//
+// [Returns]
+//   (double): Frecency score.
+//
+{   // {{{
+
+    return record.count * frecency_weight(now - record.last);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors of ArgumentHistory
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ArgumentHistory::ArgumentHistory(void) : filepath(get_arguments_path()), fd(-1), addr(nullptr)
+{   // {{{
+
+}   // }}}
+
+ArgumentHistory::~ArgumentHistory(void)
+{   // {{{
+
+    if (this->addr != nullptr)
+        munmap(this->addr, sizeof(ArgumentHeader) + ARGUMENTS_MAX_RECORDS * sizeof(ArgumentRecord));
+
+    if (this->fd >= 0)
+        close(this->fd);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions of ArgumentHistory
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+ArgumentHistory::find(const std::string& command, std::vector<ArgumentEntry>& target) noexcept
+{   // {{{
+
+    if (command.empty() or (command.size() >= sizeof(ArgumentRecord::command)) or (not this->map(false)))
+        return;
+
+    const ArgumentRecord* records = reinterpret_cast<const ArgumentRecord*>(static_cast<const char*>(this->addr) + sizeof(ArgumentHeader));
+    const int64_t         now     = std::time(nullptr);
+
+    // The shared lock prevents reading a record being written by another process.
+    flock(this->fd, LOCK_SH);
+
+    for (size_t idx = 0; idx < ARGUMENTS_MAX_RECORDS; ++idx)
+    {
+        const ArgumentRecord& record = records[idx];
+
+        if ((record.last != 0) and (std::strncmp(record.command, command.c_str(), sizeof(record.command)) == 0))
+            target.push_back({std::string(record.arguments, strnlen(record.arguments, sizeof(record.arguments))), record.count, record.last, frecency_score(record, now)});
+    }
+
+    flock(this->fd, LOCK_UN);
+
+    std::sort(target.begin(), target.end(), [](const ArgumentEntry& a, const ArgumentEntry& b) { return (a.score != b.score) ? (a.score > b.score) : (a.last > b.last); });
+
+}   // }}}
+
+void
+ArgumentHistory::record(const std::string& line) noexcept
+{   // {{{
+
+    std::string command, arguments;
+
+    // Skip the command lines that does not fit in a record.
+    if ((not split_command(line, command, arguments)) or (command.size() >= sizeof(ArgumentRecord::command)) or (arguments.size() >= sizeof(ArgumentRecord::arguments)))
+        return;
+
+    if (not this->map(true))
+        return;
+
+    ArgumentRecord* records = reinterpret_cast<ArgumentRecord*>(static_cast<char*>(this->addr) + sizeof(ArgumentHeader));
+    const int64_t   now     = std::time(nullptr);
+
+    flock(this->fd, LOCK_EX);
+
+    ArgumentRecord* found   = nullptr;  // Record of the same command line.
+    ArgumentRecord* unused  = nullptr;  // First unused record.
+    ArgumentRecord* weakest = nullptr;  // Record of the lowest score.
+    ArgumentRecord* sibling = nullptr;  // Record of the lowest score of the same command.
+    size_t          n_same  = 0;
+
+    for (size_t idx = 0; (idx < ARGUMENTS_MAX_RECORDS) and (found == nullptr); ++idx)
+    {
+        ArgumentRecord& record = records[idx];
+
+        if (record.last == 0)
+        {
+            if (unused == nullptr) unused = &record;
+            continue;
+        }
+
+        // The least recently launched one is replaced among the records of the same score.
+        auto weaker = [&record, now](const ArgumentRecord* other)
+        {
+            const double score = frecency_score(record, now);
+            return (other == nullptr) or (score < frecency_score(*other, now)) or ((score == frecency_score(*other, now)) and (record.last < other->last));
+        };
+
+        if (weaker(weakest))
+            weakest = &record;
+
+        if (std::strncmp(record.command, command.c_str(), sizeof(record.command)) != 0)
+            continue;
+
+        if (std::strncmp(record.arguments, arguments.c_str(), sizeof(record.arguments)) == 0)
+            found = &record;
+
+        if (weaker(sibling))
+            sibling = &record;
+
+        n_same += 1;
+    }
+
+    // Count the same command line in one record.
+    if (found != nullptr)
+    {
+        found->count += 1;
+        found->last   = now;
+    }
+
+    // Otherwise replace the weakest record of the command if the command has too many records,
+    // so that a frequently used command does not evict the arguments of the other commands.
+    else
+    {
+        ArgumentRecord* record = (n_same >= ARGUMENTS_MAX_PER_COMMAND) ? sibling : ((unused != nullptr) ? unused : weakest);
+
+        std::memset(record, 0, sizeof(ArgumentRecord));
+        std::memcpy(record->command, command.data(), command.size());
+        std::memcpy(record->arguments, arguments.data(), arguments.size());
+        record->count = 1;
+        record->last  = now;
+    }
+
+    flock(this->fd, LOCK_UN);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions of ArgumentHistory
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+ArgumentHistory::map(const bool create) noexcept
+{   // {{{
+
+    const size_t size = sizeof(ArgumentHeader) + ARGUMENTS_MAX_RECORDS * sizeof(ArgumentRecord);
+
+    if (this->addr != nullptr)
+        return true;
+
+    if (this->filepath.empty())
+        return false;
+
+    if (create)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(this->filepath).parent_path(), ec);
+    }
+
+    const int fd = open(this->filepath.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0), 0644);
+    if (fd < 0)
+        return false;
+
+    // Initialize the new file under the lock, so that the other processes never see a partial one.
+    struct stat st;
+    flock(fd, LOCK_EX);
+
+    bool valid = (fstat(fd, &st) == 0);
+    if (valid and (st.st_size == 0) and create)
+    {
+        ArgumentHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, ARGUMENTS_MAGIC, sizeof(header.magic));
+        header.n_records = ARGUMENTS_MAX_RECORDS;
+
+        valid = (ftruncate(fd, size) == 0) and (pwrite(fd, &header, sizeof(header), 0) == sizeof(header));
+    }
+    else valid = valid and (static_cast<size_t>(st.st_size) == size);
+
+    flock(fd, LOCK_UN);
+
+    void* addr = valid ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+
+    // Ignore the file of another format.
+    const ArgumentHeader* header = static_cast<const ArgumentHeader*>(addr);
+    if ((addr != MAP_FAILED) and ((std::memcmp(header->magic, ARGUMENTS_MAGIC, sizeof(header->magic)) != 0) or (header->n_records != ARGUMENTS_MAX_RECORDS)))
+    {
+        munmap(addr, size);
+        addr = MAP_FAILED;
+    }
+
+    if (addr == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    this->fd   = fd;
+    this->addr = addr;
+
+    return true;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors of ArgumentProvider
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ArgumentProvider::ArgumentProvider(const Config& settings) : settings(settings)
+{   // {{{
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions of ArgumentProvider
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+ArgumentProvider::query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    // The arguments are completed after the command name and a space are typed.
+    const size_t space = input.find(' ');
+    if ((space == 0) or (space == std::string::npos))
+        return;
+
+    const size_t      start = std::min(input.find_first_not_of(' ', space), input.size());
+    const std::string typed = input.substr(start);
+
+    std::vector<ArgumentEntry> entries;
+    this->history.find(input.substr(0, space), entries);
+
+    std::string lower(typed);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const char c) { return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c; });
+
+    for (const ArgumentEntry& entry : entries)
+    {
+        if (cancelled and cancelled())
+            return;
+
+        int32_t score = 0;
+        if ((not typed.empty()) and (not match_label(typed, lower, entry.arguments, score, this->settings)))
+            continue;
+
+        const std::string label = input.substr(0, start) + entry.arguments;
+        items.push_back({label, label, score});
+    }
+
+    // The entries are sorted by the frecency score, which is kept for the same matching score.
+    std::stable_sort(items.begin(), items.end(), [](const ProviderItem& a, const ProviderItem& b) { return a.score > b.score; });
+
+    if (items.size() > PROVIDER_MAX_ITEMS)
+        items.resize(PROVIDER_MAX_ITEMS);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
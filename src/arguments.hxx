@@ -0,0 +1,146 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: arguments.hxx                                                               ///
+///                                                                                              ///
+/// This file provides the "ArgumentHistory" class that stores the arguments of the launched     ///
+/// commands (e.g. "prod-db-3" of "ssh prod-db-3") in a memory-mapped file of a fixed size, and  ///
+/// the "ArgumentProvider" class that completes the arguments by the frecency score of them.     ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef ARGUMENTS_HXX
+#define ARGUMENTS_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Include custom headers.
+#include "provider.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    std::string arguments;  // Arguments of the command.
+    uint32_t    count;      // Number of launches with the arguments.
+    int64_t     last;       // Time of the last launch (UNIX time).
+    double      score;      // Frecency score.
+} ArgumentEntry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ArgumentHistory
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         ArgumentHistory(void);
+        ~ArgumentHistory(void);
+        // [Abstract]
+        //   Construct the argument history. The file is not accessed until it is needed.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        find(const std::string& command, std::vector<ArgumentEntry>& target) noexcept;
+        // [Abstract]
+        //   Get the arguments launched with the given command in the descending order of the
+        //   frecency score. The records are read directly from the shared mapping of the file,
+        //   therefore the launches of the other processes are visible without reloading.
+        //
+        // [Args]
+        //   command (const std::string&)         : [IN]  Command name.
+        //   target  (std::vector<ArgumentEntry>&): [OUT] Arguments of the command.
+
+        void
+        record(const std::string& line) noexcept;
+        // [Abstract]
+        //   Record the arguments of the given command line. The same arguments of the same command
+        //   are counted in one record. If the command or the file has too many records, the record
+        //   of the lowest frecency score is replaced.
+        //
+        // [Args]
+        //   line (const std::string&): [IN] Launched command line (e.g. "ssh prod-db-3").
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::string filepath;
+        // Path to the argument history file.
+
+        int fd;
+        // File descriptor of the argument history file used for the file lock, or -1.
+
+        void* addr;
+        // Address of the mapped file, or nullptr if not mapped yet.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        bool
+        map(const bool create) noexcept;
+        // [Abstract]
+        //   Map the argument history file if not mapped yet.
+        //
+        // [Args]
+        //   create (const bool): [IN] Create the file if it does not exist.
+        //
+        // [Returns]
+        //   (bool): True if the file is mapped.
+};
+
+class ArgumentProvider : public Provider
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        explicit ArgumentProvider(const Config& settings);
+        // [Abstract]
+        //   Construct the provider with the given config values, which must outlive this instance.
+        //
+        // [Args]
+        //   settings (const Config&): [IN] Config values.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "provider.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept override;
+        // [Abstract]
+        //   Find the arguments launched with the command of the user input (the first word) that
+        //   match to the typed arguments. The label is the whole command line. The arguments are
+        //   ordered by the frecency score for the same matching score, therefore "ssh " shows the
+        //   most frequently and recently used host first.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const Config& settings;
+        // Config values (the matching mode).
+
+        ArgumentHistory history;
+        // Launched arguments.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
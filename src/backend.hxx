@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: backend.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "Backend" class, the interface between the "MainWindow" class and the ///
+/// window system. The window draws into an off-screen buffer of the backend and presents the    ///
+/// changed region, and receives the key events through the backend.                            ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BACKEND_HXX
+#define BACKEND_HXX
+
+// Include the headers of STL.
+#include <cstddef>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Colors available for drawing.
+#define COLOR_BLACK (0)
+#define COLOR_WHITE (1)
+#define COLOR_RED   (2)
+#define COLOR_GREEN (3)
+#define COLOR_BLUE  (4)
+#define N_COLORS    (5)
+
+// Types of the events.
+#define EVENT_NONE   (0)
+#define EVENT_EXPOSE (1)
+#define EVENT_KEY    (2)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+} Rect;
+
+typedef struct {
+    int32_t type;  // One of EVENT_*.
+    char    key;   // Pressed key for EVENT_KEY ('\r', 27 for escape, 8 for backspace and 9 for tab).
+    Rect    rect;  // Exposed region for EVENT_EXPOSE.
+} BackendEvent;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Backend
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        virtual ~Backend(void) {}
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        virtual int32_t
+        fd(void) const noexcept = 0;
+        // [Abstract]
+        //   Returns the file descriptor which becomes readable when an event arrives.
+
+        virtual bool
+        pending(void) noexcept = 0;
+        // [Abstract]
+        //   Returns true if an event is queued and "next_event()" does not block.
+
+        virtual void
+        next_event(BackendEvent& event) noexcept = 0;
+        // [Abstract]
+        //   Dequeue the next event, blocking until it arrives. The events which are not used by
+        //   the window are returned as EVENT_NONE.
+        //
+        // [Args]
+        //   event (BackendEvent&): [OUT] Dequeued event.
+
+        virtual void
+        set_title(int32_t argc, char *argv[]) noexcept = 0;
+        // [Abstract]
+        //   Set the window title and the command line given to the window manager.
+        //
+        // [Args]
+        //   argc (int32_t): [IN] The number of command line arguments.
+        //   argv (char*[]): [IN] The values of command line arguments.
+
+        virtual void
+        map(void) noexcept = 0;
+        // [Abstract]
+        //   Show the window. The contents are drawn when the EVENT_EXPOSE event arrives.
+
+        virtual void
+        unmap(void) noexcept = 0;
+        // [Abstract]
+        //   Hide the window.
+
+        virtual void
+        flush(void) noexcept = 0;
+        // [Abstract]
+        //   Send the buffered requests to the window system.
+
+        virtual int32_t
+        ascent(void) const noexcept = 0;
+        // [Abstract]
+        //   Returns the ascent of the font in pixels.
+
+        virtual int32_t
+        descent(void) const noexcept = 0;
+        // [Abstract]
+        //   Returns the descent of the font in pixels.
+
+        virtual int32_t
+        max_advance(void) const noexcept = 0;
+        // [Abstract]
+        //   Returns the maximum advance width of the glyphs in pixels.
+
+        virtual int32_t
+        text_width(const char* text, const size_t size) noexcept = 0;
+        // [Abstract]
+        //   Returns the advance width of the given UTF-8 text without a round trip to the server.
+        //
+        // [Args]
+        //   text (const char*) : [IN] UTF-8 text.
+        //   size (const size_t): [IN] Size of the text in bytes.
+        //
+        // [Returns]
+        //   (int32_t): Width of the text in pixels.
+
+        virtual void
+        fill(const Rect& rect) noexcept = 0;
+        // [Abstract]
+        //   Fill the given region of the buffer with the background color (COLOR_BLACK).
+        //
+        // [Args]
+        //   rect (const Rect&): [IN] Region to be filled.
+
+        virtual void
+        draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept = 0;
+        // [Abstract]
+        //   Draw the given UTF-8 text to the buffer.
+        //
+        // [Args]
+        //   color    (const int32_t): [IN] One of COLOR_*.
+        //   x        (const int32_t): [IN] Left position of the text.
+        //   baseline (const int32_t): [IN] Vertical position of the baseline.
+        //   text     (const char*)  : [IN] UTF-8 text.
+        //   size     (const size_t) : [IN] Size of the text in bytes.
+
+        virtual void
+        present(const Rect& rect) noexcept = 0;
+        // [Abstract]
+        //   Copy the given region of the buffer to the window. Nothing happens if the region is
+        //   empty.
+        //
+        // [Args]
+        //   rect (const Rect&): [IN] Region to be copied.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: batch.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "batch.hxx"
+
+// Include the headers of STL.
+#include <chrono>
+#include <string>
+#include <string_view>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Size of the output written at once.
+#define BATCH_FLUSH_SIZE (65536)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void
+append_json_string(std::string& target, const std::string_view str) noexcept
+// [Abstract]
+//   Append the given string to the target as a JSON string literal. The bytes other than the
+//   quotes, the backslashes and the control characters are written as is.
+//
+// [Args]
+//   target (std::string&)          : [OUT] Output buffer.
+//   str    (const std::string_view): [IN]  String to be written.
+//
+{   // {{{
+
+    static const char HEX[] = "0123456789abcdef";
+
+    target.push_back('"');
+
+    for (const char c : str)
+    {
+        if      (c == '"' ) target.append("\\\"");
+        else if (c == '\\') target.append("\\\\");
+        else if (c == '\n') target.append("\\n");
+        else if (c == '\t') target.append("\\t");
+        else if (static_cast<uint8_t>(c) < 0x20)
+        {
+            target.append("\\u00");
+            target.push_back(HEX[static_cast<uint8_t>(c) >> 4]);
+            target.push_back(HEX[static_cast<uint8_t>(c) & 15]);
+        }
+        else target.push_back(c);
+    }
+
+    target.push_back('"');
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t
+run_queries(Complete& complete, std::istream& input, std::ostream& output) noexcept
+{   // {{{
+
+    std::string line, buffer;
+    size_t      count = 0;
+
+    while (std::getline(input, line))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        complete.update(line);
+        const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        buffer.append("{\"query\":");
+        append_json_string(buffer, line);
+        buffer.append(",\"candidates\":[");
+
+        for (size_t idx = 0; idx < complete.size(); ++idx)
+        {
+            if (idx > 0) buffer.push_back(',');
+            append_json_string(buffer, complete.get(idx, ""));
+        }
+
+        buffer.append("],\"usec\":").append(std::to_string(usec)).append("}\n");
+        ++count;
+
+        if (buffer.size() >= BATCH_FLUSH_SIZE)
+        {
+            output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+
+    output.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    output.flush();
+
+    return count;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
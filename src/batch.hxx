@@ -0,0 +1,43 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: batch.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the function `run_queries` which completes many user inputs without any   ///
+/// window and writes the candidates as JSON lines, for evaluating the ranking offline.          ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef BATCH_HXX
+#define BATCH_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <istream>
+#include <ostream>
+
+// Include custom headers.
+#include "complete.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t
+run_queries(Complete& complete, std::istream& input, std::ostream& output) noexcept;
+// [Abstract]
+//   Read the user inputs line by line, and write the candidates of each of them as one JSON line
+//   in the same order, e.g. {"query":"fi","candidates":["find","firefox"],"usec":12}, where "usec"
+//   is the time spent by "Complete::update()". The consecutive inputs sharing a prefix reuse the
+//   matched ranges as well as the typing, therefore sorted inputs are completed faster.
+//   Nothing is launched and no history is recorded. The output is reproducible only if the
+//   providers are waited without the deadline (negative "provider_deadline").
+//
+// [Args]
+//   complete (Complete&)    : [IN]  Completion whose command names are already loaded.
+//   input    (std::istream&): [IN]  User inputs separated by newlines.
+//   output   (std::ostream&): [OUT] JSON lines.
+//
+// [Returns]
+//   (size_t): Number of the completed inputs.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,532 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: cache.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "cache.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Include custom headers.
+#include "scan.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Magic number at the head of the command index file (8 bytes, includes format version). The
+// version 03 records the status of each file to detect the change of the execute bit.
+#define CACHE_MAGIC ("HRGIDX03")
+
+// File name of the command index.
+#define CACHE_FILENAME ("commands.idx")
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The command index file has the following layout:
+//
+//   CacheHeader                              (32 bytes)
+//   CacheDir[n_dirs]                         (32 bytes each)
+//   CacheEntry[n_entries]                    (40 bytes each)
+//   uint32_t[n_names]    : merged command names (including aliases), sorted and unique
+//   char[pool_size]      : NUL terminated strings referred by the offsets above
+//
+// The entries are the regular files and the symbolic links of each directory sorted per
+// directory, including the non-executable ones whose execute bit may be set later. All names
+// and paths are stored as offsets in the string pool.
+
+typedef struct
+{
+    char     magic[8];
+    uint64_t key;
+    uint32_t n_dirs;
+    uint32_t n_entries;
+    uint32_t n_names;
+    uint32_t pool_size;
+}
+CacheHeader;
+
+typedef struct
+{
+    uint32_t  name;
+    uint32_t  reserved;
+    FileStamp stamp;
+}
+CacheEntry;
+
+typedef struct
+{
+    uint32_t path;
+    uint32_t first;
+    uint32_t count;
+    uint32_t reserved;
+    int64_t  mtime_sec;
+    int64_t  mtime_nsec;
+}
+CacheDir;
+
+typedef struct
+{
+    std::string            path;
+    struct timespec        mtime;
+    std::vector<ScanEntry> entries;
+}
+DirState;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class MappedCache
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        explicit MappedCache(const std::string& filepath) noexcept;
+        ~MappedCache(void) noexcept;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        bool
+        is_valid(void) const noexcept { return this->header != nullptr; }
+        // [Abstract]
+        //   Returns true if the command index is successfully mapped and passed the sanity check.
+
+        const CacheDir*
+        find_dir(const std::string& path) const noexcept;
+        // [Abstract]
+        //   Returns the cached directory entry of the given path, or nullptr if not found.
+        //
+        // [Args]
+        //   path (const std::string&): [IN] Directory path.
+
+        const char*
+        str(const uint32_t offset) const noexcept { return this->pool + offset; }
+        // [Abstract]
+        //   Returns a string in the string pool.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const CacheHeader* header;
+        const CacheDir*    dirs;
+        const CacheEntry*  entries;
+        const uint32_t*    names;
+        const char*        pool;
+
+    private:
+
+        void*  addr;
+        size_t size;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MappedCache::MappedCache(const std::string& filepath) noexcept
+    : header(nullptr), dirs(nullptr), entries(nullptr), names(nullptr), pool(nullptr), addr(nullptr), size(0)
+{   // {{{
+
+    // Open the index file. Do nothing if not exists.
+    const int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    // Map the whole file.
+    struct stat st;
+    if ((fstat(fd, &st) == 0) and (static_cast<size_t>(st.st_size) >= sizeof(CacheHeader)))
+    {
+        void* ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED)
+        {
+            this->addr = ptr;
+            this->size = st.st_size;
+        }
+    }
+    close(fd);
+
+    if (this->addr == nullptr)
+        return;
+
+    // Check the header.
+    const CacheHeader* head = static_cast<const CacheHeader*>(this->addr);
+    if (std::memcmp(head->magic, CACHE_MAGIC, sizeof(head->magic)) != 0)
+        return;
+
+    // Check the file size.
+    const size_t expected = sizeof(CacheHeader) + sizeof(CacheDir) * head->n_dirs + sizeof(CacheEntry) * head->n_entries
+                          + sizeof(uint32_t) * head->n_names + head->pool_size;
+    if ((expected != this->size) or (head->pool_size == 0))
+        return;
+
+    // Compute the position of each section.
+    const char* base = static_cast<const char*>(this->addr);
+    const CacheDir*   dirs_ptr    = reinterpret_cast<const CacheDir*>(base + sizeof(CacheHeader));
+    const CacheEntry* entries_ptr = reinterpret_cast<const CacheEntry*>(dirs_ptr + head->n_dirs);
+    const uint32_t*   names_ptr   = reinterpret_cast<const uint32_t*>(entries_ptr + head->n_entries);
+    const char*       pool_ptr    = reinterpret_cast<const char*>(names_ptr + head->n_names);
+
+    // Check that all offsets point inside the pool, and the strings in the pool are terminated.
+    if (pool_ptr[head->pool_size - 1] != '\0')
+        return;
+
+    for (uint32_t i = 0; i < head->n_dirs; ++i)
+        if ((dirs_ptr[i].path >= head->pool_size) or (dirs_ptr[i].first > head->n_entries) or (dirs_ptr[i].count > head->n_entries - dirs_ptr[i].first))
+            return;
+
+    for (uint32_t i = 0; i < head->n_entries; ++i)
+        if (entries_ptr[i].name >= head->pool_size)
+            return;
+
+    for (uint32_t i = 0; i < head->n_names; ++i)
+        if (names_ptr[i] >= head->pool_size)
+            return;
+
+    // Now the index is available.
+    this->header    = head;
+    this->dirs    = dirs_ptr;
+    this->entries = entries_ptr;
+    this->names   = names_ptr;
+    this->pool    = pool_ptr;
+
+}   // }}}
+
+MappedCache::~MappedCache(void) noexcept
+{   // {{{
+
+    if (this->addr != nullptr)
+        munmap(this->addr, this->size);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const CacheDir*
+MappedCache::find_dir(const std::string& path) const noexcept
+{   // {{{
+
+    for (uint32_t i = 0; i < this->header->n_dirs; ++i)
+        if (path == this->str(this->dirs[i].path))
+            return &this->dirs[i];
+
+    return nullptr;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint64_t
+compute_key(const std::vector<std::string>& paths, const std::vector<std::string>& aliases) noexcept
+// [Abstract]
+//   Compute the FNV-1a hash of the given directories and alias names.
+//
+// [Args]
+//   paths   (const std::vector<std::string>&): [IN] Directories to be searched.
+//   aliases (const std::vector<std::string>&): [IN] Alias names.
+//
+// [Returns]
+//   (uint64_t): Hash value.
+//
+{   // {{{
+
+    uint64_t hash = 14695981039346656037ULL;
+
+    // Hash the given string including the terminating NUL character.
+    auto feed = [&hash](const std::string& str)
+    {
+        for (size_t idx = 0; idx <= str.size(); ++idx)
+            hash = (hash ^ static_cast<uint8_t>(str.c_str()[idx])) * 1099511628211ULL;
+    };
+
+    for (const std::string& path : paths)
+        feed(path);
+
+    // Separator between the directories and the aliases.
+    feed(std::string());
+
+    for (const std::string& alias : aliases)
+        feed(alias);
+
+    return hash;
+
+}   // }}}
+
+static std::string
+get_cache_path(void) noexcept
+// [Abstract]
+//   Returns the path to the command index file.
+//
+// [Returns]
+//   (std::string): "$XDG_CACHE_HOME/hiruge/commands.idx" or "~/.cache/hiruge/commands.idx".
+//
+{   // {{{
+
+    const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+    const char* home      = std::getenv("HOME");
+
+    std::filesystem::path root;
+    if      ((xdg_cache != nullptr) and (xdg_cache[0] != '\0')) root = std::filesystem::path(xdg_cache);
+    else if (home != nullptr)                                   root = std::filesystem::path(home) / ".cache";
+    else                                                        return std::string();
+
+    return (root / "hiruge" / CACHE_FILENAME).string();
+
+}   // }}}
+
+static void
+write_cache(const std::string& filepath, const uint64_t key, const std::vector<DirState>& dirs,
+            const std::vector<std::string>& names) noexcept
+// [Abstract]
+//   Write the command index file. The file is replaced atomically, therefore concurrent
+//   processes always see a complete index.
+//
+// [Args]
+//   filepath (const std::string&)             : [IN] Path to the index file.
+//   key      (const uint64_t)                 : [IN] Hash of the directories and alias names.
+//   dirs     (const std::vector<DirState>&)   : [IN] Scanned directories.
+//   names    (const std::vector<std::string>&): [IN] Merged command names.
+//
+{   // {{{
+
+    std::string                                         pool;
+    std::unordered_map<std::string_view, uint32_t>      offsets;
+    std::vector<CacheDir>                               table_dirs;
+    std::vector<CacheEntry>                             table_entries;
+    std::vector<uint32_t>                               table_names;
+
+    // Append the given string to the pool and returns its offset.
+    auto append = [&pool](const std::string& str) -> uint32_t
+    {
+        const uint32_t offset = pool.size();
+        pool.append(str.c_str(), str.size() + 1);
+        return offset;
+    };
+
+    for (const DirState& dir : dirs)
+    {
+        CacheDir entry;
+        entry.path       = append(dir.path);
+        entry.first      = table_entries.size();
+        entry.count      = dir.entries.size();
+        entry.reserved   = 0;
+        entry.mtime_sec  = dir.mtime.tv_sec;
+        entry.mtime_nsec = dir.mtime.tv_nsec;
+        table_dirs.push_back(entry);
+
+        for (const ScanEntry& file : dir.entries)
+        {
+            const uint32_t offset = append(file.name);
+            offsets.emplace(file.name, offset);
+            table_entries.push_back({offset, 0, file.stamp});
+        }
+    }
+
+    // The merged names share the strings with the directory names, except for the aliases.
+    for (const std::string& name : names)
+    {
+        const auto iter = offsets.find(name);
+        table_names.push_back((iter != offsets.end()) ? iter->second : append(name));
+    }
+
+    // Make sure that the pool is never empty.
+    if (pool.empty())
+        pool.push_back('\0');
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.key         = key;
+    header.n_dirs    = table_dirs.size();
+    header.n_entries = table_entries.size();
+    header.n_names   = table_names.size();
+    header.pool_size = pool.size();
+
+    // Write to a temporary file and rename it to the index file.
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), ec);
+
+    const std::string tmppath = filepath + "." + std::to_string(getpid());
+    const int fd = open(tmppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+
+    bool ok = true;
+    auto put = [&fd, &ok](const void* data, size_t size)
+    {
+        const char* ptr = static_cast<const char*>(data);
+        while (ok and (size > 0))
+        {
+            const ssize_t n = write(fd, ptr, size);
+            if (n <= 0) { ok = false; break; }
+            ptr  += n;
+            size -= n;
+        }
+    };
+
+    put(&header, sizeof(header));
+    put(table_dirs.data(),    sizeof(CacheDir)   * table_dirs.size());
+    put(table_entries.data(), sizeof(CacheEntry) * table_entries.size());
+    put(table_names.data(),   sizeof(uint32_t)   * table_names.size());
+    put(pool.data(),          pool.size());
+    close(fd);
+
+    if (ok) ok = (rename(tmppath.c_str(), filepath.c_str()) == 0);
+    if (not ok) unlink(tmppath.c_str());
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+load_commands(const std::vector<std::string>& paths, const std::vector<std::string>& aliases,
+              Catalog& target) noexcept
+{   // {{{
+
+    // Compute the key of the current directories and aliases.
+    const uint64_t key = compute_key(paths, aliases);
+
+    // Get the modification time of all existing directories.
+    std::vector<DirState> dirs;
+    for (const std::string& path : paths)
+    {
+        struct stat st;
+        if ((stat(path.c_str(), &st) == 0) and S_ISDIR(st.st_mode))
+            dirs.push_back({path, st.st_mtim, {}});
+    }
+
+    // Map the command index.
+    const std::string filepath = get_cache_path();
+    const MappedCache cache(filepath);
+
+    // Find the cached directories which have the same modification time.
+    std::vector<const CacheDir*> cached(dirs.size(), nullptr);
+
+    for (size_t idx = 0; cache.is_valid() and (idx < dirs.size()); ++idx)
+    {
+        const CacheDir* entry = cache.find_dir(dirs[idx].path);
+        if ((entry != nullptr) and (entry->mtime_sec == dirs[idx].mtime.tv_sec) and (entry->mtime_nsec == dirs[idx].mtime.tv_nsec))
+            cached[idx] = entry;
+    }
+
+    // The execute bit and the target of a link can be changed without modifying the directory.
+    // Check the status of the cached files of the unmodified directories.
+    std::vector<std::vector<ScannedEntry>> scanned(dirs.size());
+
+    for (size_t idx = 0; idx < dirs.size(); ++idx)
+    {
+        if (cached[idx] == nullptr)
+            continue;
+
+        scanned[idx].reserve(cached[idx]->count);
+        for (uint32_t pos = 0; pos < cached[idx]->count; ++pos)
+        {
+            const CacheEntry& entry = cache.entries[cached[idx]->first + pos];
+            scanned[idx].push_back({cache.str(entry.name), entry.stamp});
+        }
+    }
+
+    std::vector<std::string> dir_paths;
+    for (const DirState& dir : dirs)
+        dir_paths.push_back(dir.path);
+
+    std::vector<bool> fresh;
+    check_directories(dir_paths, scanned, fresh);
+
+    for (size_t idx = 0; idx < dirs.size(); ++idx)
+        fresh[idx] = fresh[idx] and (cached[idx] != nullptr);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Fast path: nothing changed since the index was written
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    if (cache.is_valid() and (cache.header->key == key) and (cache.header->n_dirs == dirs.size())
+        and std::all_of(fresh.begin(), fresh.end(), [](const bool value) { return value; }))
+    {
+        target.reserve(cache.header->n_names, cache.header->pool_size);
+        for (uint32_t idx = 0; idx < cache.header->n_names; ++idx)
+            target.append(cache.str(cache.names[idx]));
+        return;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Slow path: rescan the modified directories only
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    std::vector<size_t>      stale;
+    std::vector<std::string> stale_paths;
+
+    for (size_t idx = 0; idx < dirs.size(); ++idx)
+    {
+        if (fresh[idx])
+        {
+            dirs[idx].entries.reserve(scanned[idx].size());
+            for (const ScannedEntry& entry : scanned[idx])
+                dirs[idx].entries.push_back({std::string(entry.name), entry.stamp});
+        }
+        else
+        {
+            stale.push_back(idx);
+            stale_paths.push_back(dirs[idx].path);
+        }
+    }
+
+    // Scan all modified directories at once in parallel.
+    std::vector<std::vector<ScanEntry>> rescanned;
+    scan_directories(stale_paths, rescanned);
+
+    for (size_t idx = 0; idx < stale.size(); ++idx)
+        dirs[stale[idx]].entries = std::move(rescanned[idx]);
+
+    // Merge the sorted command names of each directory and the aliases without duplication.
+    // Only the executable files are commands.
+    std::vector<std::vector<std::string>> runs;
+    for (const DirState& dir : dirs)
+    {
+        runs.emplace_back();
+        for (const ScanEntry& entry : dir.entries)
+            if (is_executable(entry.stamp))
+                runs.back().push_back(entry.name);
+    }
+
+    runs.push_back(aliases);
+    std::sort(runs.back().begin(), runs.back().end());
+
+    std::vector<std::string> names;
+    merge_names(runs, names);
+
+    // Update the command index.
+    if (not filepath.empty())
+        write_cache(filepath, key, dirs, names);
+
+    for (const std::string& name : names)
+        target.append(name);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,40 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: cache.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the function `load_commands` which reads the command names from the       ///
+/// on-disk command index, and rescans only the directories that was modified since the index    ///
+/// was written.                                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CACHE_HXX
+#define CACHE_HXX
+
+// Include the headers of STL.
+#include <string>
+#include <vector>
+
+// Include custom headers.
+#include "catalog.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+load_commands(const std::vector<std::string>& paths, const std::vector<std::string>& aliases,
+              Catalog& target) noexcept;
+// [Abstract]
+//   Get all command names in the given directories and the given alias names, and append them
+//   to the given empty catalog. The on-disk command index "$XDG_CACHE_HOME/hiruge/commands.idx" is
+//   memory-mapped and used as is if the directory list, the alias names, the modification
+//   time of all directories and the status of all files (e.g. the execute bit) are unchanged.
+//   Otherwise, only the modified directories are rescanned and the index is rewritten.
+//
+// [Args]
+//   paths   (const std::vector<std::string>&): [IN]  Directories to be searched.
+//   aliases (const std::vector<std::string>&): [IN]  Alias names.
+//   target  (Catalog&)                       : [OUT] The command names will be stored in this variable.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
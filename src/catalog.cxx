@@ -0,0 +1,171 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: catalog.cxx                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "catalog.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Catalog::Catalog(void) : lowers(FUZZY_PADDING, '\0'), garbage(0)
+{   // {{{
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+Catalog::reserve(const size_t n_names, const size_t n_bytes) noexcept
+{   // {{{
+
+    this->entries.reserve(n_names);
+    this->names.reserve(n_bytes + n_names);
+    this->lowers.reserve(n_bytes + n_names + FUZZY_PADDING);
+
+}   // }}}
+
+void
+Catalog::append(const std::string_view name) noexcept
+{   // {{{
+
+    this->entries.push_back(this->store(name));
+
+}   // }}}
+
+bool
+Catalog::insert(const std::string_view name) noexcept
+{   // {{{
+
+    const uint32_t index = this->lower_bound(name);
+
+    // Do nothing if already exists.
+    if ((index < this->size()) and (this->name(index) == name))
+        return false;
+
+    // The name is stored at the end of the arenas, and only the entry is inserted.
+    const CatalogEntry entry = this->store(name);
+    this->entries.insert(this->entries.begin() + index, entry);
+
+    return true;
+
+}   // }}}
+
+size_t
+Catalog::merge(const std::vector<std::string>& sorted) noexcept
+{   // {{{
+
+    std::vector<CatalogEntry> merged;
+    merged.reserve(this->entries.size() + sorted.size());
+
+    size_t index = 0;
+    size_t added = 0;
+
+    for (const std::string& name : sorted)
+    {
+        // Move the existing entries which precede the name.
+        while ((index < this->entries.size()) and (this->name(index) < name))
+            merged.push_back(this->entries[index++]);
+
+        // Skip if already exists.
+        if ((index < this->entries.size()) and (this->name(index) == name))
+            continue;
+
+        if (this->names.size() + name.size() + 1 > UINT32_MAX)
+            break;
+
+        merged.push_back(this->store(name));
+        ++added;
+    }
+
+    merged.insert(merged.end(), this->entries.begin() + index, this->entries.end());
+    this->entries = std::move(merged);
+
+    return added;
+
+}   // }}}
+
+bool
+Catalog::erase(const std::string_view name) noexcept
+{   // {{{
+
+    uint32_t index;
+    if (not this->find(name, index))
+        return false;
+
+    this->garbage += this->entries[index].length + 1;
+    this->entries.erase(this->entries.begin() + index);
+
+    if (this->garbage > this->names.size() / 2)
+        this->compact();
+
+    return true;
+
+}   // }}}
+
+uint32_t
+Catalog::lower_bound(const std::string_view name) const noexcept
+{   // {{{
+
+    const auto iter = std::partition_point(this->entries.begin(), this->entries.end(), [this, &name](const CatalogEntry& entry)
+    {
+        return std::string_view(this->names.data() + entry.offset, entry.length) < name;
+    });
+
+    return iter - this->entries.begin();
+
+}   // }}}
+
+bool
+Catalog::find(const std::string_view name, uint32_t& index) const noexcept
+{   // {{{
+
+    index = this->lower_bound(name);
+    return (index < this->size()) and (this->name(index) == name);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+CatalogEntry
+Catalog::store(const std::string_view name) noexcept
+{   // {{{
+
+    const CatalogEntry entry = {static_cast<uint32_t>(this->names.size()), static_cast<uint32_t>(name.size())};
+
+    this->names.insert(this->names.end(), name.begin(), name.end());
+    this->names.push_back('\0');
+
+    // Overwrite the padding and add the padding again.
+    this->lowers.resize(entry.offset);
+    for (const char c : name)
+        this->lowers.push_back((('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c);
+    this->lowers.resize(this->names.size() + FUZZY_PADDING, '\0');
+
+    return entry;
+
+}   // }}}
+
+void
+Catalog::compact(void) noexcept
+{   // {{{
+
+    Catalog compacted;
+    compacted.reserve(this->size(), this->names.size() - this->garbage);
+
+    for (uint32_t index = 0; index < this->size(); ++index)
+        compacted.append(this->name(index));
+
+    *this = std::move(compacted);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: catalog.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "Catalog" class that stores the sorted command names in contiguous    ///
+/// byte arenas. Each name is referred by a 32-bit index in the dictionary order.                ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef CATALOG_HXX
+#define CATALOG_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Include custom headers.
+#include "fuzzy.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint32_t offset;  // Position of the name in the arenas.
+    uint32_t length;  // Length of the name.
+} CatalogEntry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Catalog
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        Catalog(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t
+        size(void) const noexcept { return this->entries.size(); }
+        // [Abstract]
+        //   Returns the number of names.
+
+        std::string_view
+        name(const uint32_t index) const noexcept { return std::string_view(this->names.data() + this->entries[index].offset, this->entries[index].length); }
+        // [Abstract]
+        //   Returns the name of the given index.
+
+        const char*
+        lower(const uint32_t index) const noexcept { return this->lowers.data() + this->entries[index].offset; }
+        // [Abstract]
+        //   Returns the NUL terminated lower case name of the given index in the lower case arena.
+
+        const char*
+        buffer(void) const noexcept { return this->lowers.data(); }
+        // [Abstract]
+        //   Returns the lower case arena, which is padded by FUZZY_PADDING bytes of NUL.
+
+        uint32_t
+        offset(const uint32_t index) const noexcept { return this->entries[index].offset; }
+        // [Abstract]
+        //   Returns the position of the name of the given index in the arenas.
+
+        void
+        reserve(const size_t n_names, const size_t n_bytes) noexcept;
+        // [Abstract]
+        //   Reserve the memory for the given number of names and bytes.
+        //
+        // [Args]
+        //   n_names (const size_t): [IN] Number of names.
+        //   n_bytes (const size_t): [IN] Total length of the names.
+
+        void
+        append(const std::string_view name) noexcept;
+        // [Abstract]
+        //   Append the given name that is greater than all existing names.
+        //   This is the fast path to build a catalog from a sorted list.
+        //
+        // [Args]
+        //   name (const std::string_view): [IN] Name to be appended.
+
+        bool
+        insert(const std::string_view name) noexcept;
+        // [Abstract]
+        //   Insert the given name keeping the order.
+        //
+        // [Args]
+        //   name (const std::string_view): [IN] Name to be inserted.
+        //
+        // [Returns]
+        //   (bool): True if the name is newly inserted.
+
+        size_t
+        merge(const std::vector<std::string>& sorted) noexcept;
+        // [Abstract]
+        //   Insert the given names at once by merging the sorted entries, which takes linear time
+        //   regardless of the number of the given names. The names which already exist are
+        //   skipped, and the names are dropped if the arenas reach the 4 GiB limit of the offsets.
+        //
+        // [Args]
+        //   sorted (const std::vector<std::string>&): [IN] Names sorted in the dictionary order without duplication.
+        //
+        // [Returns]
+        //   (size_t): Number of the inserted names.
+
+        bool
+        erase(const std::string_view name) noexcept;
+        // [Abstract]
+        //   Erase the given name. The arenas are compacted if the erased bytes become large.
+        //
+        // [Args]
+        //   name (const std::string_view): [IN] Name to be erased.
+        //
+        // [Returns]
+        //   (bool): True if the name is erased.
+
+        uint32_t
+        lower_bound(const std::string_view name) const noexcept;
+        // [Abstract]
+        //   Returns the index of the first name that is not less than the given name.
+        //
+        // [Args]
+        //   name (const std::string_view): [IN] Name to be searched.
+        //
+        // [Returns]
+        //   (uint32_t): Index of the lower bound.
+
+        bool
+        find(const std::string_view name, uint32_t& index) const noexcept;
+        // [Abstract]
+        //   Search the given name.
+        //
+        // [Args]
+        //   name  (const std::string_view): [IN]  Name to be searched.
+        //   index (uint32_t&)             : [OUT] Index of the name if found.
+        //
+        // [Returns]
+        //   (bool): True if found.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<CatalogEntry> entries;
+        // Position and length of the names in the dictionary order.
+
+        std::vector<char> names;
+        // Arena of the NUL terminated names.
+
+        std::vector<char> lowers;
+        // Arena of the NUL terminated lower case names followed by FUZZY_PADDING bytes of NUL.
+        // The name of the same index is located at the same position as "this->names".
+
+        size_t garbage;
+        // Total bytes of the erased names remaining in the arenas.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        CatalogEntry
+        store(const std::string_view name) noexcept;
+        // [Abstract]
+        //   Store the given name at the end of the arenas.
+        //
+        // [Args]
+        //   name (const std::string_view): [IN] Name to be stored.
+        //
+        // [Returns]
+        //   (CatalogEntry): Position and length of the stored name.
+
+        void
+        compact(void) noexcept;
+        // [Abstract]
+        //   Rebuild the arenas without the erased names in the dictionary order.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -7,10 +7,22 @@
 
 // Include standard libraries.
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <iostream>
+
+// Include POSIX headers.
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // Include custom headers.
+#include "cache.hxx"
 #include "config.hxx"
+#include "fuzzy.hxx"
+#include "spawn.hxx"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Constants
@@ -19,34 +31,89 @@
 // Maxium number of candidates.
 #define N_MAX_CANDIDATES (8)
 
+// Weight of the frecency score in the blended score of the fuzzy mode.
+#define FRECENCY_WEIGHT (8.0)
+
+// Number of command names examined between the cancellation checks.
+#define CANCEL_CHECK_INTERVAL (4096)
+
+// Minimum length of the user input searched by the trigram index.
+#define TRIGRAM_MIN_QUERY (3)
+
+// The trigram index is used if the shortest posting list is this times shorter than the previous
+// matches, because decoding a posting is cheaper than searching a name but not negligible.
+#define TRIGRAM_COST_RATIO (4)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    int32_t  score;   // Matching score (larger is better).
+    uint32_t length;  // Length of the command name.
+    uint32_t index;   // Index of the command name.
+}
+Scored;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 static bool
-is_substr(const std::string& str1, const std::string& str2) noexcept
+is_better(const Scored& a, const Scored& b) noexcept
+// [Abstract]
+//   Returns true if "a" is a better candidate than "b". Shorter names and then the dictionary
+//   order are preferred if the scores are the same.
+//
+// [Args]
+//   a (const Scored&): [IN] Scored name.
+//   b (const Scored&): [IN] Scored name.
+//
+// [Returns]
+//   (bool): True if "a" is better.
+//
+{   // {{{
+
+    if (a.score  != b.score ) return a.score  > b.score;
+    if (a.length != b.length) return a.length < b.length;
+    return a.index < b.index;
+
+}   // }}}
+
+static int32_t
+char_at(const std::string_view str, const size_t depth) noexcept
 // [Abstract]
-//   Returns true if the "str1" is a substring of "str2".
+//   Returns the character at the given position as an unsigned value,
+//   or -1 if the string is shorter than the given position.
 //
 // [Args]
-//   str1 (const std::string&): [IN] The 1st string.
-//   str2 (const std::string&): [IN] The 2nd string.
+//   str   (const std::string_view): [IN] Target string.
+//   depth (const size_t)          : [IN] Position of the character.
 //
 // [Returns]
-//   (bool): True if the "str1" is a substring of "str2".
+//   (int32_t): Character code at the position, or -1.
 //
 {   // {{{
 
-    // Initialize the string index.
-    size_t idx = 0;
+    return (depth < str.size()) ? static_cast<uint8_t>(str[depth]) : -1;
+
+}   // }}}
 
-    // Increment the index while the character "str1[idx]" and "str2[idx]" are the same.
-    while ((idx < str1.size()) and (idx < str2.size()) and (str1[idx] == str2[idx]))
-        ++idx;
+static char
+to_lower(const char c) noexcept
+// [Abstract]
+//   Returns the lower case of the given ASCII character.
+//
+// [Args]
+//   c (const char): [IN] Input character.
+//
+// [Returns]
+//   (char): Lower case character.
+//
+{   // {{{
 
-    // Returns true if the "str1" is used up.
-    if (idx >= str1.size()) return true;
-    else                    return false;
+    return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
 
 }   // }}}
 
@@ -96,41 +163,50 @@ split(const std::string& str, const std::string& delim) noexcept
 
 }   // }}}
 
-static void
-get_system_commands(std::vector<std::string>& target) noexcept
+static std::vector<std::string>
+get_system_paths(void) noexcept
 // [Abstract]
-//   Search all command in "PATH" environment variable and store them
-//   into the given "target" variable.
+//   Returns all directories in "PATH" environment variable without duplication.
 //
-// [Args]
-//    target (std::vector<std::string>&): [OUT] The command name will be stored in this variable.
+// [Returns]
+//   (std::vector<std::string>): Directories in "PATH" in the order of appearance.
 //
 {   // {{{
 
-    // Split PATH by ':'.
-    std::vector<std::string> target_paths = split(std::string(std::getenv("PATH")), ":");
+    // Get PATH environment variable.
+    const char* env = std::getenv("PATH");
+    if (env == nullptr)
+        return std::vector<std::string>();
 
-    // Remove duplicated taregt path.
-    target_paths.erase(std::unique(target_paths.begin(), target_paths.end()), target_paths.end());
+    // Split PATH by ':' and remove duplicated taregt paths.
+    std::vector<std::string> target_paths;
+    for (const std::string& path : split(std::string(env), ":"))
+        if ((not path.empty()) and (std::find(target_paths.begin(), target_paths.end(), path) == target_paths.end()))
+            target_paths.emplace_back(path);
 
-    // Search all directories in PATH and get all executable files.
-    for (const std::string& path : target_paths)
-    {
-        // Skip if the path is not a directory.
-        if (not std::filesystem::is_directory(path))
-            continue;
+    return target_paths;
 
-        // Appand all files in the directory.
-        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(path))
-        {
-            // Skip if the path is not a regular file or symbolic link.
-            if (not (entry.is_regular_file() or entry.is_symlink()))
-                continue;
+}   // }}}
 
-            // Add the command name.
-            target.emplace_back(entry.path().filename());
-        }
-    }
+static bool
+is_command_file(const std::string& dir, const std::string& name) noexcept
+// [Abstract]
+//   Returns true if the given file in the given directory is an executable regular file or
+//   a symbolic link to it.
+//
+// [Args]
+//   dir  (const std::string&): [IN] Directory path.
+//   name (const std::string&): [IN] File name.
+//
+// [Returns]
+//   (bool): True if the file is a command candidate.
+//
+{   // {{{
+
+    struct stat st;
+    const std::string path = dir + "/" + name;
+
+    return (stat(path.c_str(), &st) == 0) and S_ISREG(st.st_mode) and ((st.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
 
 }   // }}}
 
@@ -138,22 +214,27 @@ get_system_commands(std::vector<std::string>& target) noexcept
 // Constructors and descructors
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-Complete::Complete(void)
+Complete::Complete(const bool picker, Config& settings)
+    : settings(settings), fuzzy(settings.match_mode == "fuzzy"), substring(settings.match_mode == "substring"), indexed(false),
+      pool(static_cast<size_t>(std::max(settings.match_threads, 0))), picker(picker), inotify_fd(-1), config_wd(-1), catalog_rank(0)
 {   // {{{
 
-    // Search all command names in "PATH" environment variable
-    // and store them into "this->commands".
-    get_system_commands(this->commands);
+    // The command names in "PATH" and the aliases share the catalog, which has the higher
+    // priority of the two providers.
+    const int32_t path_rank  = provider_rank("path", this->settings);
+    const int32_t alias_rank = provider_rank("alias", this->settings);
+
+    if      (path_rank  < 0) this->catalog_rank = alias_rank;
+    else if (alias_rank < 0) this->catalog_rank = path_rank;
+    else                     this->catalog_rank = std::min(path_rank, alias_rank);
 
-    // Add all aliases to "this->commands".
-    for (const auto& item : config.aliases)
-        this->commands.emplace_back(item.first);
+}   // }}}
 
-    // Sort the array of command names.
-    std::sort(this->commands.begin(), this->commands.end());
+Complete::~Complete(void)
+{   // {{{
 
-    // Remove duplicated command names.
-    this->commands.erase(std::unique(this->commands.begin(), this->commands.end()), this->commands.end());
+    if (this->inotify_fd >= 0)
+        close(this->inotify_fd);
 
 }   // }}}
 
@@ -161,66 +242,881 @@ Complete::Complete(void)
 // Member functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void
+Complete::load(void) noexcept
+{   // {{{
+
+    // Get all alias names.
+    std::vector<std::string> aliases;
+    if (provider_rank("alias", this->settings) >= 0)
+        for (const auto& item : this->settings.aliases)
+            aliases.emplace_back(item.first);
+
+    // Get all command names in "PATH" environment variable and aliases as a sorted list without
+    // duplication, and store them into "this->catalog". The result is served from the on-disk
+    // command index if the directories are not modified.
+    this->catalog = Catalog();
+    this->ranges.clear();
+    this->candidates.clear();
+    this->merged.clear();
+    this->indexed = false;
+
+    if (not this->picker)
+        load_commands((provider_rank("path", this->settings) >= 0) ? get_system_paths() : std::vector<std::string>(), aliases, this->catalog);
+
+}   // }}}
+
+bool
+Complete::add_provider(const std::string& name, std::unique_ptr<Provider>&& provider) noexcept
+{   // {{{
+
+    const int32_t rank = provider_rank(name, this->settings);
+
+    // The picker mode selects one of the given names only.
+    if ((rank < 0) or this->picker)
+        return false;
+
+    this->providers.add(std::move(provider), rank);
+    this->snapshots.resize(this->providers.size());
+
+    return true;
+
+}   // }}}
+
+void
+Complete::set_provider_callback(const std::function<void(void)>& callback) noexcept
+{   // {{{
+
+    this->providers.set_callback(callback);
+
+}   // }}}
+
+bool
+Complete::append(const std::vector<std::string>& sorted) noexcept
+{   // {{{
+
+    if (this->catalog.merge(sorted) == 0)
+        return false;
+
+    // The candidates, the matched ranges and the trigram index refer to the shifted indices.
+    this->candidates.clear();
+    this->merged.clear();
+    this->ranges.clear();
+    this->indexed = false;
+
+    return true;
+
+}   // }}}
+
 int32_t
-Complete::exec(const std::string& input) const noexcept
+Complete::exec(const std::string& input) noexcept
 {   // {{{
 
     // Get the command name to be executed.
-    std::string target = this->get(0, input);
+    const std::string name(this->get(0, input));
+
+    // Just print the selected name in the picker mode.
+    if (this->picker)
+    {
+        std::cout << name << std::endl;
+        return 0;
+    }
+
+    // The item of a provider is launched by the provider. Only the command lines (e.g. a completed
+    // path or arguments) are recorded, and the applications and the windows are not.
+    if ((this->providers.size() > 0) and (not this->merged.empty()) and (this->merged[0].slot >= 0))
+    {
+        const MergedItem&   merged = this->merged[0];
+        const ProviderItem& item   = this->snapshots[merged.slot][merged.index];
+        const int32_t       error  = this->providers.provider(merged.slot).launch(item);
+
+        if ((error == 0) and (item.action == item.label) and (provider_rank("args", this->settings) >= 0))
+            this->arguments.record(item.action);
+
+        return error;
+    }
 
     // If the command name exists in the aliases, then replace to the alias contents.
-    if (config.aliases.find(target) != config.aliases.end())
-        target = config.aliases[target];
+    const auto        iter   = this->settings.aliases.find(name);
+    const std::string target = (iter != this->settings.aliases.end()) ? iter->second : name;
+
+    // Execute the command.
+    const int32_t error = spawn_command(target);
 
-    // Create a command to be executed.
-    const std::string cmd = target + " 1>/dev/null 2>/dev/null &";
+    // Record the launch for the frecency ranking. The typed command line with arguments is
+    // recorded as the command name and the arguments.
+    if (error == 0)
+    {
+        this->history.record(name.substr(0, name.find(' ')));
+
+        if (provider_rank("args", this->settings) >= 0)
+            this->arguments.record(name);
+    }
 
-    // Execite the command.
-    return system(cmd.c_str());
+    return error;
 
 }   // }}}
 
-const std::string&
-Complete::get(const size_t index, const std::string& default_value) const noexcept
+std::string_view
+Complete::get(const size_t index, const std::string_view default_value) const noexcept
 {   // {{{
 
+    // Returns the corresponding merged candidate if any provider is added.
+    if (this->providers.size() > 0)
+    {
+        if (index >= this->merged.size())
+            return default_value;
+
+        const MergedItem& item = this->merged[index];
+        return (item.slot < 0) ? this->catalog.name(item.index) : std::string_view(this->snapshots[item.slot][item.index].label);
+    }
+
     // Returns the corresponding candidate if the index is valid.
     if (index < this->candidates.size())
-        return *this->candidates[index];
+        return this->catalog.name(this->candidates[index]);
 
     // Otherwise, returns the default value.
     return default_value;
 
 }   // }}}
 
-void
-Complete::update(const std::string& input) noexcept
+size_t
+Complete::size(void) const noexcept
+{   // {{{
+
+    return (this->providers.size() > 0) ? this->merged.size() : this->candidates.size();
+
+}   // }}}
+
+bool
+Complete::update(const std::string& input, const std::function<bool(void)>& cancelled) noexcept
 {   // {{{
 
     // Clear all candidates.
     this->candidates.clear();
+    this->merged.clear();
+
+    // Start the queries of the providers first so that they run while the command names are
+    // matched on this thread.
+    if ((this->providers.size() > 0) and (input.size() > 0))
+        this->providers.request(input);
+
+    // The bottom of the stack is the whole range of the command names that matches to the empty
+    // input. The stack is reset when the command names are changed.
+    if (this->ranges.empty())
+    {
+        this->ranges.push_back({0, 0, this->catalog.size(), {}, {}, false});
+        this->query.clear();
+    }
+
+    // Compute the length of the common prefix of the previous input and the current input.
+    size_t common = 0;
+    while ((common < input.size()) and (common < this->query.size()) and (input[common] == this->query[common]))
+        ++common;
+
+    // Pop the ranges of the prefixes which are no longer a prefix of the user input.
+    // In case of backspace, this is the only operation needed to get the matched range.
+    while (this->ranges.back().length > common)
+        this->ranges.pop_back();
+
+    // Narrow the range for each additional character of the user input. The ranges pushed so far
+    // remain valid if cancelled, because they only depend on the prefix of the user input.
+    this->query = input;
+
+    size_t depth = this->ranges.back().length;
+
+    // The trigram index does not need the ranges of the shorter inputs. Skip them so that the
+    // whole names are never scanned for a long input (e.g. pasted text).
+    if (this->substring and this->settings.trigram_index and (depth == 0) and (input.size() >= TRIGRAM_MIN_QUERY))
+        depth = TRIGRAM_MIN_QUERY - 1;
+
+    for (; depth < input.size(); ++depth)
+    {
+        if (cancelled and cancelled())
+            return false;
+
+        if      (this->fuzzy    ) { if (not this->narrow_fuzzy(input, depth, cancelled)) return false;     }
+        else if (this->substring) { if (not this->narrow_substring(input, depth, cancelled)) return false; }
+        else                      { this->narrow_prefix(input, depth);                                      }
+    }
 
     // Do nothing if the user input is empty.
     if (input.size() == 0)
+        return true;
+
+    MatchRange& top = this->ranges.back();
+
+    // Register the best matched names as candidates in the fuzzy mode.
+    if (this->fuzzy)
+    {
+        if ((not top.ranked) and (not this->rank_fuzzy(top, input, cancelled)))
+            return false;
+
+        this->candidates = top.best;
+    }
+
+    // Register the earliest matches as candidates in the substring mode.
+    else if (this->substring)
+    {
+        if ((not top.ranked) and (not this->rank_substring(top, cancelled)))
+            return false;
+
+        this->candidates = top.best;
+    }
+
+    // Register the command names in the matched range as candidates until the number of candidates
+    // reaches the max number, because the computation time will unnecessarily increase if
+    // the number of candidate is too big.
+    else
+    {
+        for (size_t idx = top.first; (idx < top.last) and (this->candidates.size() < N_MAX_CANDIDATES); ++idx)
+            this->candidates.push_back(idx);
+    }
+
+    // Move the frequently and recently launched commands up.
+    if ((not this->picker) and (provider_rank("history", this->settings) >= 0))
+        this->rank_history(input);
+
+    // Merge the items of the providers which arrive before the deadline. The others are merged
+    // by calling this function again when they arrive. A negative deadline waits for all of them.
+    if (this->providers.size() > 0)
+    {
+        if (not this->providers.wait(1000 * static_cast<int64_t>(this->settings.provider_deadline), cancelled))
+            return false;
+
+        this->merge(input);
+    }
+
+    return true;
+
+}   // }}}
+
+int32_t
+Complete::watch(void) noexcept
+{   // {{{
+
+    this->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this->inotify_fd < 0)
+        return -1;
+
+    // Watch all directories in "PATH" if the command names are used.
+    for (const std::string& path : (provider_rank("path", this->settings) >= 0) ? get_system_paths() : std::vector<std::string>())
+    {
+        const int32_t wd = inotify_add_watch(this->inotify_fd, path.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_ONLYDIR);
+        if (wd >= 0)
+            this->watch_dirs[wd] = path;
+    }
+
+    // Watch the directory containing the config file instead of the file itself, because editors
+    // often replace the file by renaming. The mask is added in case the directory is also in "PATH".
+    if (not this->settings.filepath.empty())
+    {
+        const std::string dir = std::filesystem::path(this->settings.filepath).parent_path().string();
+        this->config_wd = inotify_add_watch(this->inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MASK_ADD);
+    }
+
+    return this->inotify_fd;
+
+}   // }}}
+
+bool
+Complete::on_watch_event(void) noexcept
+{   // {{{
+
+    const std::string config_name = std::filesystem::path(this->settings.filepath).filename().string();
+
+    bool changed = false;
+    bool reload  = false;
+
+    // Read all pending events. The read never blocks because the inotify instance is non-blocking.
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t size;
+
+    while ((size = read(this->inotify_fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (char* ptr = buffer; ptr < buffer + size; ptr += sizeof(struct inotify_event) + reinterpret_cast<struct inotify_event*>(ptr)->len)
+        {
+            const struct inotify_event* event = reinterpret_cast<struct inotify_event*>(ptr);
+
+            // Skip the events without file name.
+            if (event->len == 0)
+                continue;
+
+            const std::string name(event->name);
+
+            // Reload aliases later if the config file is modified.
+            if ((event->wd == this->config_wd) and (name == config_name))
+                reload = true;
+
+            // Skip if the event is not for the directories in "PATH".
+            const auto iter = this->watch_dirs.find(event->wd);
+            if (iter == this->watch_dirs.end())
+                continue;
+
+            // Added or renamed executable.
+            if ((event->mask & (IN_CREATE | IN_MOVED_TO)) and is_command_file(iter->second, name))
+                changed |= this->insert_command(name);
+
+            // Removed or renamed executable.
+            if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+                changed |= this->erase_command(name);
+
+            // Execute bit changed.
+            if (event->mask & IN_ATTRIB)
+            {
+                if (is_command_file(iter->second, name)) changed |= this->insert_command(name);
+                else                                     changed |= this->erase_command(name);
+            }
+        }
+    }
+
+    if (reload)
+        changed |= this->reload_aliases();
+
+    // The candidates, the matched ranges and the trigram index may point to the moved elements.
+    if (changed)
+    {
+        this->candidates.clear();
+        this->merged.clear();
+        this->ranges.clear();
+        this->indexed = false;
+    }
+
+    return changed;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+Complete::narrow_prefix(const std::string& input, const size_t depth) noexcept
+{   // {{{
+
+    // All command names in the top range share the same prefix, therefore they are sorted by
+    // the next character and the narrowed range can be found by binary search inside the top range.
+    const MatchRange& top = this->ranges.back();
+    const int32_t     key = static_cast<uint8_t>(input[depth]);
+
+    // Returns the first index in [first, last) where the predicate becomes false.
+    auto partition_point = [this, depth](size_t first, size_t last, auto pred) -> size_t
+    {
+        while (first < last)
+        {
+            const size_t mid = first + (last - first) / 2;
+            if (pred(char_at(this->catalog.name(mid), depth))) first = mid + 1;
+            else                                                last  = mid;
+        }
+        return first;
+    };
+
+    const size_t lower = partition_point(top.first, top.last, [key](const int32_t c) { return c <  key; });
+    const size_t upper = partition_point(lower,     top.last, [key](const int32_t c) { return c == key; });
+
+    this->ranges.push_back({depth + 1, lower, upper, {}, {}, false});
+
+}   // }}}
+
+bool
+Complete::narrow_fuzzy(const std::string& input, const size_t depth, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    const MatchRange& top = this->ranges.back();
+    const char*       buf = this->catalog.buffer();
+    const char        key = to_lower(input[depth]);
+
+    MatchRange range = {depth + 1, 0, 0, {}, {}, false};
+    bool       completed;
+
+    if (depth == 0)
+    {
+        // Stream the whole arena in the dictionary order. The search stops at either the key or
+        // the end of the current name.
+        completed = this->collect_matches(this->catalog.size(), [this, buf, key](const size_t index, FuzzyMatch& match)
+        {
+            const uint32_t pos = fuzzy_find(buf, this->catalog.offset(index), key);
+
+            match = {static_cast<uint32_t>(index), pos + 1};
+            return buf[pos] != '\0';
+        }, range.matches, cancelled);
+    }
+    else
+    {
+        // The names matched to the longer input are always a subset of the names matched to the
+        // shorter input. Continue the search from the end of the previous match of each name.
+        completed = this->collect_matches(top.matches.size(), [&top, buf, key](const size_t idx, FuzzyMatch& match)
+        {
+            const size_t pos = fuzzy_find(buf, top.matches[idx].end, key);
+
+            match = {top.matches[idx].index, static_cast<uint32_t>(pos + 1)};
+            return buf[pos] != '\0';
+        }, range.matches, cancelled);
+    }
+
+    if (not completed)
+        return false;
+
+    this->ranges.push_back(std::move(range));
+
+    return true;
+
+}   // }}}
+
+bool
+Complete::rank_fuzzy(MatchRange& range, const std::string& input, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    std::string lower(input);
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+
+    return this->select_best(range, fuzzy_bound(input), [this, &input, &lower](const FuzzyMatch& match) -> int32_t
+    {
+        const uint32_t offset = this->catalog.offset(match.index);
+        return fuzzy_score(this->catalog.name(match.index).data(), this->catalog.buffer() + offset, match.end - offset - 1, input, lower);
+    }, cancelled);
+
+}   // }}}
+
+bool
+Complete::narrow_substring(const std::string& input, const size_t depth, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    const MatchRange& top    = this->ranges.back();
+    const size_t      length = depth + 1;
+
+    std::string lower(input, 0, length);
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+
+    MatchRange range = {length, 0, 0, {}, {}, false};
+
+    // Returns the position in the arena right after the first match in the given name,
+    // or zero if not matched. The search starts from the given position in the arena.
+    auto find = [this, &lower](const uint32_t index, const uint32_t start) -> uint32_t
+    {
+        const uint32_t offset = this->catalog.offset(index);
+        const uint32_t end    = offset + this->catalog.name(index).size();
+        const char*    buf    = this->catalog.buffer();
+        const void*    hit    = memmem(buf + start, end - start, lower.data(), lower.size());
+
+        return (hit == nullptr) ? 0 : static_cast<uint32_t>(static_cast<const char*>(hit) - buf + lower.size());
+    };
+
+    // The bottom of the stack has no match list because all names match the empty input.
+    const bool whole = (top.length == 0);
+
+    // Build the index lazily when it is needed first. The index is not used if it is empty, or
+    // filtering the previous matches is expected to be cheaper.
+    const bool indexable = this->settings.trigram_index and (length >= TRIGRAM_MIN_QUERY);
+
+    if (indexable and (not this->indexed))
+    {
+        this->trigrams.build(this->catalog);
+        this->indexed = true;
+    }
+
+    bool completed = true;
+
+    if (indexable and (not this->trigrams.empty()) and (whole or (TRIGRAM_COST_RATIO * this->trigrams.estimate(lower) < top.matches.size())))
+    {
+        // The found names always contain the input, so only the position is computed here.
+        std::vector<uint32_t> found;
+        this->trigrams.search(this->catalog, lower, found);
+
+        range.matches.reserve(found.size());
+        for (const uint32_t index : found)
+            range.matches.push_back({index, find(index, this->catalog.offset(index))});
+    }
+    else if (whole)
+    {
+        completed = this->collect_matches(this->catalog.size(), [this, &find](const size_t index, FuzzyMatch& match)
+        {
+            match = {static_cast<uint32_t>(index), find(index, this->catalog.offset(index))};
+            return match.end != 0;
+        }, range.matches, cancelled);
+    }
+    else
+    {
+        // The first match of the longer input never starts before the first match of the
+        // shorter input.
+        completed = this->collect_matches(top.matches.size(), [&top, &find](const size_t idx, FuzzyMatch& match)
+        {
+            const FuzzyMatch& previous = top.matches[idx];
+
+            match = {previous.index, find(previous.index, previous.end - top.length)};
+            return match.end != 0;
+        }, range.matches, cancelled);
+    }
+
+    if (not completed)
+        return false;
+
+    this->ranges.push_back(std::move(range));
+
+    return true;
+
+}   // }}}
+
+bool
+Complete::rank_substring(MatchRange& range, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    // The earlier match has the higher score, and the match at the head has the best score.
+    return this->select_best(range, 0, [this, &range](const FuzzyMatch& match) -> int32_t
+    {
+        return -static_cast<int32_t>(match.end - this->catalog.offset(match.index) - range.length);
+    }, cancelled);
+
+}   // }}}
+
+template <typename Test>
+bool
+Complete::collect_matches(const size_t n_items, const Test& test, std::vector<FuzzyMatch>& target, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    const size_t n_chunks = (n_items + CANCEL_CHECK_INTERVAL - 1) / CANCEL_CHECK_INTERVAL;
+
+    target.clear();
+
+    // Collect the matches directly if there is no other thread or only one chunk. The number of
+    // the items is the upper bound of the matches, which avoids the reallocation in the loop.
+    if ((this->pool.size() == 1) or (n_chunks <= 1))
+    {
+        FuzzyMatch match;
+        target.reserve(n_items);
+
+        for (size_t idx = 0; idx < n_items; ++idx)
+        {
+            if ((idx % CANCEL_CHECK_INTERVAL == 0) and cancelled and cancelled())
+                return false;
+
+            if (test(idx, match))
+                target.push_back(match);
+        }
+
+        return true;
+    }
+
+    // Each chunk is a task of the thread pool. The matches of the chunks are concatenated in the
+    // order of the chunks, therefore the result is the same as the sequential loop.
+    std::vector<std::vector<FuzzyMatch>> chunks(n_chunks);
+
+    const bool completed = this->pool.run(n_chunks, [n_items, &test, &chunks, &cancelled](const size_t chunk, const size_t)
+    {
+        if (cancelled and cancelled())
+            return false;
+
+        const size_t first = chunk * CANCEL_CHECK_INTERVAL;
+        const size_t last  = std::min(first + CANCEL_CHECK_INTERVAL, n_items);
+        FuzzyMatch   match;
+
+        for (size_t idx = first; idx < last; ++idx)
+            if (test(idx, match))
+                chunks[chunk].push_back(match);
+
+        return true;
+    });
+
+    if (not completed)
+        return false;
+
+    // Concatenate the chunks in parallel as well, because the copy is not negligible compared to
+    // the matching when most names match (e.g. the first character of the input).
+    std::vector<size_t> offsets(n_chunks + 1, 0);
+    for (size_t chunk = 0; chunk < n_chunks; ++chunk)
+        offsets[chunk + 1] = offsets[chunk] + chunks[chunk].size();
+
+    target.resize(offsets[n_chunks]);
+
+    this->pool.run(n_chunks, [&chunks, &offsets, &target](const size_t chunk, const size_t)
+    {
+        std::copy(chunks[chunk].begin(), chunks[chunk].end(), target.begin() + offsets[chunk]);
+        std::vector<FuzzyMatch>().swap(chunks[chunk]);
+        return true;
+    });
+
+    return true;
+
+}   // }}}
+
+template <typename Score>
+bool
+Complete::select_best(MatchRange& range, const int32_t bound, const Score& score, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    // Keep the best N_MAX_CANDIDATES names of each thread using a heap whose top is the worst one.
+    const size_t                     n_chunks = (range.matches.size() + CANCEL_CHECK_INTERVAL - 1) / CANCEL_CHECK_INTERVAL;
+    std::vector<std::vector<Scored>> heaps(this->pool.size());
+
+    const bool completed = this->pool.run(n_chunks, [this, &range, bound, &score, &heaps, &cancelled](const size_t chunk, const size_t thread)
+    {
+        if (cancelled and cancelled())
+            return false;
+
+        // Work on a local copy so that the threads do not write to the adjacent vectors.
+        std::vector<Scored> heap;
+        heap.reserve(N_MAX_CANDIDATES);
+        heap.swap(heaps[thread]);
+
+        const size_t first = chunk * CANCEL_CHECK_INTERVAL;
+        const size_t last  = std::min(first + CANCEL_CHECK_INTERVAL, range.matches.size());
+
+        for (size_t idx = first; idx < last; ++idx)
+        {
+            const FuzzyMatch& match  = range.matches[idx];
+            const uint32_t    length = this->catalog.name(match.index).size();
+
+            // Skip the scoring if the name cannot be better than the worst one even with the best
+            // possible score. The comparison includes the index because the chunks are visited
+            // in any order.
+            if ((heap.size() >= N_MAX_CANDIDATES) and (not is_better({bound, length, match.index}, heap.front())))
+                continue;
+
+            const Scored scored = {score(match), length, match.index};
+
+            if (heap.size() < N_MAX_CANDIDATES)
+            {
+                heap.push_back(scored);
+                std::push_heap(heap.begin(), heap.end(), is_better);
+            }
+            else if (is_better(scored, heap.front()))
+            {
+                std::pop_heap(heap.begin(), heap.end(), is_better);
+                heap.back() = scored;
+                std::push_heap(heap.begin(), heap.end(), is_better);
+            }
+        }
+
+        heap.swap(heaps[thread]);
+
+        return true;
+    });
+
+    if (not completed)
+        return false;
+
+    // Merge the heaps of the threads.
+    std::vector<Scored> merged;
+    for (const std::vector<Scored>& heap : heaps)
+        merged.insert(merged.end(), heap.begin(), heap.end());
+
+    std::sort(merged.begin(), merged.end(), is_better);
+    merged.resize(std::min<size_t>(merged.size(), N_MAX_CANDIDATES));
+
+    range.best.clear();
+    for (const Scored& scored : merged)
+        range.best.push_back(scored.index);
+
+    range.ranked = true;
+
+    return true;
+
+}   // }}}
+
+void
+Complete::merge(const std::string& input) noexcept
+{   // {{{
+
+    for (size_t slot = 0; slot < this->providers.size(); ++slot)
+        this->providers.items(slot, input, this->snapshots[slot]);
+
+    std::string lower(input);
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+
+    // The command names are scored in the same way as the items of the providers. Note that the
+    // order of "this->candidates" may differ from the score because of the launch history.
+    std::vector<int32_t> scores(this->candidates.size(), 0);
+    for (size_t idx = 0; idx < this->candidates.size(); ++idx)
+        match_label(input, lower, this->catalog.name(this->candidates[idx]), scores[idx], this->settings);
+
+    // Position of the next item of each source. The last one is for the command names.
+    std::vector<size_t> heads(this->providers.size() + 1, 0);
+
+    while (this->merged.size() < N_MAX_CANDIDATES)
+    {
+        int32_t best_slot  = -2;
+        int32_t best_score = 0;
+        int32_t best_rank  = 0;
+
+        // Find the best head among the sources.
+        for (int32_t slot = -1; slot < static_cast<int32_t>(this->providers.size()); ++slot)
+        {
+            const size_t  head  = heads[(slot < 0) ? this->providers.size() : slot];
+            const size_t  size  = (slot < 0) ? this->candidates.size() : this->snapshots[slot].size();
+            const int32_t rank  = (slot < 0) ? this->catalog_rank : this->providers.rank(slot);
+
+            if (head >= size)
+                continue;
+
+            const int32_t score = (slot < 0) ? scores[head] : this->snapshots[slot][head].score;
+
+            if ((best_slot == -2) or (score > best_score) or ((score == best_score) and (rank < best_rank)))
+            {
+                best_slot  = slot;
+                best_score = score;
+                best_rank  = rank;
+            }
+        }
+
+        // All sources are exhausted.
+        if (best_slot == -2)
+            break;
+
+        size_t&          head  = heads[(best_slot < 0) ? this->providers.size() : best_slot];
+        const MergedItem item  = {best_slot, static_cast<uint32_t>((best_slot < 0) ? this->candidates[head] : head)};
+        ++head;
+
+        // Skip the same label as the better candidate.
+        const std::string_view label = (item.slot < 0) ? this->catalog.name(item.index) : std::string_view(this->snapshots[item.slot][item.index].label);
+        const bool duplicated = std::any_of(this->merged.begin(), this->merged.end(), [this, label](const MergedItem& other)
+        {
+            return label == ((other.slot < 0) ? this->catalog.name(other.index) : std::string_view(this->snapshots[other.slot][other.index].label));
+        });
+
+        if (not duplicated)
+            this->merged.push_back(item);
+    }
+
+}   // }}}
+
+void
+Complete::rank_history(const std::string& input) noexcept
+{   // {{{
+
+    const std::vector<HistoryEntry>& entries = this->history.entries();
+    if (entries.empty())
         return;
 
-    for (const std::string& name : this->commands)
+    typedef struct {
+        double   score;
+        uint32_t length;
+        uint32_t index;
+    } Ranked;
+
+    std::string lower(input);
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+
+    // Returns the fuzzy score of the command name at the given index.
+    auto score_of = [this, &input, &lower](const uint32_t index, const size_t end) -> double
+    {
+        return fuzzy_score(this->catalog.name(index).data(), this->catalog.lower(index), end, input, lower);
+    };
+
+    std::vector<Ranked> ranked;
+
+    // The current candidates without the frecency score.
+    for (const uint32_t index : this->candidates)
+    {
+        size_t end = 0;
+
+        if (this->fuzzy) fuzzy_match(this->catalog.lower(index), lower, end);
+        ranked.push_back({this->fuzzy ? score_of(index, end) : 0.0, static_cast<uint32_t>(this->catalog.name(index).size()), index});
+    }
+
+    const size_t n_current = ranked.size();
+
+    // The history entries that match to the user input with the frecency score.
+    for (const HistoryEntry& entry : entries)
+    {
+        // Skip quickly in the prefix mode.
+        if ((not this->fuzzy) and (not this->substring) and (entry.name.compare(0, input.size(), input) != 0))
+            continue;
+
+        // Skip if the command no longer exists.
+        uint32_t index;
+        if (not this->catalog.find(entry.name, index))
+            continue;
+
+        const double bonus = FRECENCY_WEIGHT * std::log2(1.0 + entry.score / 10.0);
+        size_t       end   = 0;
+
+        // Skip if the lower case name does not contain the input in the substring mode.
+        if (this->substring and (memmem(this->catalog.lower(index), entry.name.size(), lower.data(), lower.size()) == nullptr))
+            continue;
+
+        if      (not this->fuzzy)                                      ranked.push_back({bonus, static_cast<uint32_t>(entry.name.size()), index});
+        else if (fuzzy_match(this->catalog.lower(index), lower, end)) ranked.push_back({score_of(index, end) + bonus, static_cast<uint32_t>(entry.name.size()), index});
+    }
+
+    // Nothing to do if no history entry matches.
+    if (ranked.size() == n_current)
+        return;
+
+    // Shorter names are preferred in the fuzzy mode as well as "rank_fuzzy". In the substring
+    // mode, the order of "rank_substring" is kept by the stable sort.
+    std::stable_sort(ranked.begin(), ranked.end(), [this](const Ranked& a, const Ranked& b)
     {
-        // Register as a candidate if the user input is a substring of the command name.
-        if (is_substr(input, name))
-            this->candidates.push_back(&name);
+        if (a.score != b.score)                   return a.score  > b.score;
+        if (this->fuzzy and (a.length != b.length)) return a.length < b.length;
+        if (this->substring)                        return false;
+        return a.index < b.index;
+    });
 
-        // Exit the loop if the number of candidates exceeds the max number, because
-        // the computation time will unnecessarily increase if the number of candidate is too big.
+    // Rebuild the candidates without duplication.
+    this->candidates.clear();
+    for (const Ranked& item : ranked)
+    {
         if (this->candidates.size() >= N_MAX_CANDIDATES)
             break;
 
-        // Exit the loop if the user input is smaller than the command name in terms of
-        // dictionary order, because the rest of command names never match.
-        if (input.compare(name) <= 0)
-            break;
+        if (std::find(this->candidates.begin(), this->candidates.end(), item.index) == this->candidates.end())
+            this->candidates.push_back(item.index);
     }
 
 }   // }}}
 
+bool
+Complete::insert_command(const std::string& name) noexcept
+{   // {{{
+
+    return this->catalog.insert(name);
+
+}   // }}}
+
+bool
+Complete::erase_command(const std::string& name) noexcept
+{   // {{{
+
+    // Keep the name if it is an alias or exists in another directory.
+    if ((provider_rank("alias", this->settings) >= 0) and (this->settings.aliases.find(name) != this->settings.aliases.end()))
+        return false;
+
+    for (const auto& item : this->watch_dirs)
+        if (is_command_file(item.second, name))
+            return false;
+
+    return this->catalog.erase(name);
+
+}   // }}}
+
+bool
+Complete::reload_aliases(void) noexcept
+{   // {{{
+
+    // Only the aliases are reloaded, because the other values are already bound to the window.
+    // The current aliases are kept if the file is broken, e.g. while an editor is saving it or
+    // after a typo, because the empty aliases would erase all of them.
+    Config loaded;
+    if (not load_config(this->settings.filepath, loaded))
+        return false;
+
+    const std::map<std::string, std::string> previous = std::move(this->settings.aliases);
+    this->settings.aliases = std::move(loaded.aliases);
+
+    bool changed = false;
+
+    // Erase removed aliases. Note that the alias is already removed from "this->settings.aliases".
+    for (const auto& item : previous)
+        if (this->settings.aliases.find(item.first) == this->settings.aliases.end())
+            changed |= this->erase_command(item.first);
+
+    // Insert added aliases if they are used.
+    for (const auto& item : this->settings.aliases)
+        if ((provider_rank("alias", this->settings) >= 0) and (previous.find(item.first) == previous.end()))
+            changed |= this->insert_command(item.first);
+
+    return changed;
+
+}   // }}}
+
 // vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
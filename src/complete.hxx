@@ -9,9 +9,46 @@
 #define COMPLETE_HXX
 
 // Include standard libraries.
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+// Include custom headers.
+#include "arguments.hxx"
+#include "catalog.hxx"
+#include "config.hxx"
+#include "history.hxx"
+#include "pool.hxx"
+#include "provider.hxx"
+#include "trigram.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint32_t index;  // Index of the matched command name.
+    uint32_t end;    // Position in the lower case arena right after the last matched character.
+} FuzzyMatch;
+
+typedef struct {
+    size_t                  length;   // Length of the user input prefix.
+    size_t                  first;    // Index of the first matched command name (prefix mode).
+    size_t                  last;     // Index of the last matched command name plus one (prefix mode).
+    std::vector<FuzzyMatch> matches;  // Matched command names (fuzzy and substring mode).
+    std::vector<uint32_t>   best;     // Indices of the best candidates in descending order of score (fuzzy and substring mode).
+    bool                    ranked;   // True if "best" is already computed (fuzzy and substring mode).
+} MatchRange;
+
+typedef struct {
+    int32_t  slot;   // Index of the provider, or -1 for the command names.
+    uint32_t index;  // Index of the item of the provider, or the index of the command name.
+} MergedItem;
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Class definition
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -24,43 +61,140 @@ class Complete
         // Constructors and descructors
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-        Complete(void);
+         explicit Complete(const bool picker = false, Config& settings = config);
+        // [Abstract]
+        //   Construct the completion with the given config values, which must outlive this
+        //   instance. The other instances than the global "config" are used by the library.
+        //
+        // [Args]
+        //   picker   (const bool): [IN] True for the picker mode.
+        //   settings (Config&)   : [IN] Config values. The aliases are updated by "on_watch_event()".
+
+        ~Complete(void);
 
         ////////////////////////////////////////////////////////////////////////////////////////////
         // Member functions
         ////////////////////////////////////////////////////////////////////////////////////////////
 
+        void
+        load(void) noexcept;
+        // [Abstract]
+        //   Load all command names in "PATH" and the alias names if the "path" and "alias"
+        //   providers are enabled. This function should be called before "update()", and may take
+        //   a long time if the command index is outdated. Nothing is loaded in the picker mode.
+
+        bool
+        add_provider(const std::string& name, std::unique_ptr<Provider>&& provider) noexcept;
+        // [Abstract]
+        //   Add a provider of the candidates if it is enabled by the config. The providers are
+        //   queried in parallel by "update()". This function must be called before "update()".
+        //
+        // [Args]
+        //   name     (const std::string&)         : [IN] Name of the provider in the config.
+        //   provider (std::unique_ptr<Provider>&&): [IN] Provider.
+        //
+        // [Returns]
+        //   (bool): True if the provider is enabled.
+
+        void
+        set_provider_callback(const std::function<void(void)>& callback) noexcept;
+        // [Abstract]
+        //   Set the function called on the provider thread when a provider missed the deadline
+        //   of "update()" but returned the result of the latest input. Then "update()" should be
+        //   called again with the same input to merge the late result.
+        //
+        // [Args]
+        //   callback (const std::function<void(void)>&): [IN] Function called for a late result.
+
+        bool
+        append(const std::vector<std::string>& sorted) noexcept;
+        // [Abstract]
+        //   Add the given names to the candidates of the completion. The candidates are cleared
+        //   if the names are changed, therefore "update()" should be called again in that case.
+        //
+        // [Args]
+        //   sorted (const std::vector<std::string>&): [IN] Names sorted in the dictionary order without duplication.
+        //
+        // [Returns]
+        //   (bool): True if any name is added.
+
         int32_t
-        exec(const std::string& input) const noexcept;
+        exec(const std::string& input) noexcept;
         // [Abstract]
-        //   Complete the given user input and execute it.
+        //   Complete the given user input and launch it as a detached process.
+        //   The launch is recorded to the history if succeeded, and the arguments of the command
+        //   line are recorded to the argument history. The item of a provider is launched by the
+        //   provider instead. In the picker mode, the completed name is printed
+        //   to the standard output instead.
         //
         // [Args]
         //   input (const std::string&): [IN] User input.
         //
         // [Returns]
-        //   (int32_t): Returns value of the executed command.
+        //   (int32_t): Zero if launched, otherwise the error number.
 
-        const std::string&
-        get(const size_t index, const std::string& default_value) const noexcept;
+        std::string_view
+        get(const size_t index, const std::string_view default_value) const noexcept;
         // [Abstract]
         //   Returns a candidate of the given index. This function returns
         //   the given default value if the given index is out of range.
         //
         // [Args]
-        //   index         (const size_t) [IN] Index of the candidate to be returned.
-        //   default_value (const size_t) [IN] Defalut value.
+        //   index         (const size_t)          : [IN] Index of the candidate to be returned.
+        //   default_value (const std::string_view): [IN] Defalut value.
         //
         // [Returns]
-        //   (const std::string&): Candidate at the given index, or the default value.
+        //   (std::string_view): Candidate at the given index, or the default value.
 
-        void
-        update(const std::string& input) noexcept;
+        size_t
+        size(void) const noexcept;
+        // [Abstract]
+        //   Returns the number of the candidates, including the merged items of the providers.
+        //
+        // [Returns]
+        //   (size_t): Number of the candidates.
+
+        bool
+        update(const std::string& input, const std::function<bool(void)>& cancelled = nullptr) noexcept;
         // [Abstract]
-        //   Update the candidate based on the given user input.
+        //   Update the candidate based on the given user input. If the user input extends the
+        //   previous one, only the previously matched range is narrowed down, and if the user
+        //   input is a prefix of the previous one (e.g. backspace), the memorized range is reused.
+        //   In the fuzzy mode, the best N_MAX_CANDIDATES matches in terms of the score are
+        //   selected as candidates instead of the first ones in the dictionary order, and in the
+        //   substring mode, the earliest matches are selected. The substring queries of 3 or more
+        //   characters are answered by the trigram index if it is enabled.
+        //   Then, the frequently and recently launched commands are moved up. Finally, the items
+        //   of the providers are merged if they arrive before the deadline.
+        //   The given function is polled during the matching, and the matching is abandoned if
+        //   it returns true. The ranges computed so far are kept and reused by the next call.
         //
         // [Args]
-        //   input (const std::string&): [IN] User input.
+        //   input     (const std::string&)              : [IN] User input.
+        //   cancelled (const std::function<bool(void)>&): [IN] Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. The candidates are empty in that case.
+
+        int32_t
+        watch(void) noexcept;
+        // [Abstract]
+        //   Start watching the directories in "PATH" and the config file using inotify.
+        //   The returned file descriptor becomes readable when they are modified, and then
+        //   "on_watch_event()" should be called.
+        //
+        // [Returns]
+        //   (int32_t): File descriptor of the inotify instance, or -1 if failed.
+
+        bool
+        on_watch_event(void) noexcept;
+        // [Abstract]
+        //   Read the pending inotify events and insert or erase the added or removed command
+        //   names incrementally. The candidates are cleared if the command names are changed,
+        //   therefore "update()" should be called again in that case.
+        //
+        // [Returns]
+        //   (bool): True if the command names are changed.
 
     private:
 
@@ -68,12 +202,226 @@ class Complete
         // Private member variables
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-        std::vector<std::string> commands;
+        Config& settings;
+        // Config values of the matching mode, the providers and the aliases.
+
+        Catalog catalog;
         // List of possible command names.
 
-        std::vector<const std::string*> candidates;
+        std::vector<uint32_t> candidates;
         // List of candidates.
-        // The elements of this vector is a pointer of strings in "this->commands".
+        // The elements of this vector is an index of names in "this->catalog".
+
+        std::string query;
+        // The user input given to the last "update()" call.
+
+        std::vector<MatchRange> ranges;
+        // Stack of the matched ranges for each prefix of "this->query".
+        // The i-th element is the range of the command names which start with the first i characters.
+
+        bool fuzzy;
+        // True if the matching mode is the fuzzy mode.
+
+        bool substring;
+        // True if the matching mode is the substring mode.
+
+        TrigramIndex trigrams;
+        // Trigram index of "this->catalog" used in the substring mode.
+
+        bool indexed;
+        // True if "this->trigrams" is up to date. The index is rebuilt lazily when it is needed.
+
+        ThreadPool pool;
+        // Threads used for the matching and the ranking of the fuzzy and substring modes.
+
+        bool picker;
+        // True if the names are given from the standard input instead of "PATH" (picker mode).
+        // The launch history is not used in this mode.
+
+        History history;
+        // Launch history.
+
+        ArgumentHistory arguments;
+        // Arguments of the launched command lines.
+
+        int32_t inotify_fd;
+        // File descriptor of the inotify instance.
+
+        std::map<int32_t, std::string> watch_dirs;
+        // Watched directories in "PATH" indexed by the watch descriptor.
+
+        int32_t config_wd;
+        // Watch descriptor of the directory containing the config file.
+
+        ProviderSet providers;
+        // Providers other than the command names, which are queried in parallel.
+
+        std::vector<std::vector<ProviderItem>> snapshots;
+        // Items of each provider merged to "this->merged".
+
+        std::vector<MergedItem> merged;
+        // Candidates merged from "this->candidates" and "this->snapshots".
+        // This is used only if any provider is added.
+
+        int32_t catalog_rank;
+        // Priority of the command names among the providers (the smaller, the higher).
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        narrow_prefix(const std::string& input, const size_t depth) noexcept;
+        // [Abstract]
+        //   Push the matched range of the first (depth + 1) characters of the user input that is
+        //   computed from the top of the stack in the prefix mode.
+        //
+        // [Args]
+        //   input (const std::string&): [IN] User input.
+        //   depth (const size_t)      : [IN] Length of the prefix of the top of the stack.
+
+        bool
+        narrow_fuzzy(const std::string& input, const size_t depth, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Push the matched names of the first (depth + 1) characters of the user input that is
+        //   computed from the top of the stack in the fuzzy mode.
+        //
+        // [Args]
+        //   input     (const std::string&)              : [IN] User input.
+        //   depth     (const size_t)                    : [IN] Length of the prefix of the top of the stack.
+        //   cancelled (const std::function<bool(void)>&): [IN] Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. Nothing is pushed in that case.
+
+        bool
+        rank_fuzzy(MatchRange& range, const std::string& input, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Select the best matched names of the given range in terms of the fuzzy score.
+        //
+        // [Args]
+        //   range     (MatchRange&)                     : [IN/OUT] Matched range.
+        //   input     (const std::string&)              : [IN]     User input.
+        //   cancelled (const std::function<bool(void)>&): [IN]     Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. The range is left unranked in that case.
+
+        bool
+        narrow_substring(const std::string& input, const size_t depth, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Push the matched names of the first (depth + 1) characters of the user input that is
+        //   computed from the top of the stack in the substring mode. The trigram index is used
+        //   instead of the top of the stack if it has too many matches.
+        //
+        // [Args]
+        //   input     (const std::string&)              : [IN] User input.
+        //   depth     (const size_t)                    : [IN] Length of the prefix of the top of the stack.
+        //   cancelled (const std::function<bool(void)>&): [IN] Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. Nothing is pushed in that case.
+
+        bool
+        rank_substring(MatchRange& range, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Select the best matched names of the given range in the substring mode. The earlier
+        //   matches, the shorter names and then the dictionary order are preferred.
+        //
+        // [Args]
+        //   range     (MatchRange&)                     : [IN/OUT] Matched range.
+        //   cancelled (const std::function<bool(void)>&): [IN]     Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. The range is left unranked in that case.
+
+        template <typename Test>
+        bool
+        collect_matches(const size_t n_items, const Test& test, std::vector<FuzzyMatch>& target, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Test the items of the index in [0, n_items) in parallel and collect the matches in the
+        //   order of the index. The items are split into chunks of CANCEL_CHECK_INTERVAL items
+        //   which are balanced among the threads of "this->pool" by work stealing. The test is a
+        //   template argument so that it is inlined into the loop over the items.
+        //
+        // [Args]
+        //   n_items   (const size_t)                     : [IN]  Number of items.
+        //   test      (const Test&)                      : [IN]  Returns true and the match if the item matches (bool(size_t, FuzzyMatch&)).
+        //   target    (std::vector<FuzzyMatch>&)         : [OUT] Matches.
+        //   cancelled (const std::function<bool(void)>&): [IN]  Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled.
+
+        template <typename Score>
+        bool
+        select_best(MatchRange& range, const int32_t bound, const Score& score, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Select the best N_MAX_CANDIDATES matches of the given range in terms of the given score
+        //   in parallel. Each thread keeps its own bounded heap, and the heaps are merged at last.
+        //   Shorter names and then the dictionary order are preferred if the scores are the same.
+        //   The score is a template argument so that it is inlined into the loop over the matches.
+        //
+        // [Args]
+        //   range     (MatchRange&)                      : [IN/OUT] Matched range.
+        //   bound     (const int32_t)                    : [IN]     Upper bound of the score.
+        //   score     (const Score&)                     : [IN]     Score of the match, larger is better (int32_t(const FuzzyMatch&)).
+        //   cancelled (const std::function<bool(void)>&): [IN]     Returns true if the result is no longer needed.
+        //
+        // [Returns]
+        //   (bool): False if cancelled. The range is left unranked in that case.
+
+        void
+        merge(const std::string& input) noexcept;
+        // [Abstract]
+        //   Merge "this->candidates" and the latest items of the providers into "this->merged".
+        //   Each source keeps its own order, and the head of the source with the best matching
+        //   score is taken at each step. The ties are broken by the priority of the sources.
+        //
+        // [Args]
+        //   input (const std::string&): [IN] User input.
+
+        void
+        rank_history(const std::string& input) noexcept;
+        // [Abstract]
+        //   Blend the frecency score of the launch history with the match score, and reorder
+        //   "this->candidates". Only the history entries need to be examined in addition to the
+        //   current candidates, because the frecency never decreases the score.
+        //
+        // [Args]
+        //   input (const std::string&): [IN] User input.
+
+        bool
+        insert_command(const std::string& name) noexcept;
+        // [Abstract]
+        //   Insert the given command name to "this->catalog" keeping the order.
+        //
+        // [Args]
+        //   name (const std::string&): [IN] Command name.
+        //
+        // [Returns]
+        //   (bool): True if the name is newly inserted.
+
+        bool
+        erase_command(const std::string& name) noexcept;
+        // [Abstract]
+        //   Erase the given command name from "this->catalog" if it is neither an alias nor
+        //   found in any other watched directory.
+        //
+        // [Args]
+        //   name (const std::string&): [IN] Command name.
+        //
+        // [Returns]
+        //   (bool): True if the name is erased.
+
+        bool
+        reload_aliases(void) noexcept;
+        // [Abstract]
+        //   Reload the aliases from the config file and apply the difference to "this->catalog".
+        //   Nothing is changed if the config file cannot be read.
+        //
+        // [Returns]
+        //   (bool): True if the command names are changed.
 };
 
 #endif
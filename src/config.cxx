@@ -35,22 +35,23 @@ show_error_message(const toml::key& section, const toml::key& value) noexcept
 //
 {   // {{{
 
-    std::cout << "\033[33m";
-    std::cout << "NiShiKi: Error occured while parsing config file\n";
-    std::cout << "NiShiKi: Undefined entry name: " << section << "." << value;
-    std::cout << "\033[m" << std::endl;
+    std::cerr << "\033[33m";
+    std::cerr << "NiShiKi: Error occured while parsing config file\n";
+    std::cerr << "NiShiKi: Undefined entry name: " << section << "." << value;
+    std::cerr << "\033[m" << std::endl;
 
 };  // }}}
 
 static void
-set_config(const toml::table& table, const toml::key& section, const toml::key& value) noexcept
+set_config(Config& target, const toml::table& table, const toml::key& section, const toml::key& value) noexcept
 // [Abstract]
-//   Read one config item to the global variable `config`.
+//   Read one config item to the given config values.
 //
 // [Args]
-//   table   (const toml::table&): [IN] Top node of the config file.
-//   section (const toml::key&)  : [IN] Section name.
-//   value   (const toml::key&)  : [IN] Value name.
+//   target  (Config&)           : [OUT] Config values.
+//   table   (const toml::table&): [IN]  Top node of the config file.
+//   section (const toml::key&)  : [IN]  Section name.
+//   value   (const toml::key&)  : [IN]  Value name.
 //
 {   // {{{
 
@@ -61,17 +62,40 @@ set_config(const toml::table& table, const toml::key& section, const toml::key&
     // Read the [GENERAL] section.
     ////////////////////////////////////////////////////////////////////////////////////////////////
 
-    if      ((section == "GENERAL") and (value == "window_width"    )) config.window_width     = node.value_or(config.window_width);
-    else if ((section == "GENERAL") and (value == "window_height"   )) config.window_height    = node.value_or(config.window_height);
-    else if ((section == "GENERAL") and (value == "window_border"   )) config.window_border    = node.value_or(config.window_border);
-    else if ((section == "GENERAL") and (value == "window_title"    )) config.window_title     = node.value_or(config.window_title);
-    else if ((section == "GENERAL") and (value == "text_left_margin")) config.text_left_margin = node.value_or(config.text_left_margin);
-    else if ((section == "GENERAL") and (value == "text_top1_margin")) config.text_top1_margin = node.value_or(config.text_top1_margin);
-    else if ((section == "GENERAL") and (value == "text_top2_margin")) config.text_top2_margin = node.value_or(config.text_top2_margin);
-    else if ((section == "GENERAL") and (value == "xft_fontname"    )) config.xft_fontname     = node.value_or(config.xft_fontname);
-    else if ((section == "GENERAL") and (value == "xft_fontsize"    )) config.xft_fontsize     = node.value_or(config.xft_fontsize);
+    if      ((section == "GENERAL") and (value == "window_width"    )) target.window_width     = node.value_or(target.window_width);
+    else if ((section == "GENERAL") and (value == "window_height"   )) target.window_height    = node.value_or(target.window_height);
+    else if ((section == "GENERAL") and (value == "window_border"   )) target.window_border    = node.value_or(target.window_border);
+    else if ((section == "GENERAL") and (value == "window_title"    )) target.window_title     = node.value_or(target.window_title);
+    else if ((section == "GENERAL") and (value == "window_backend"  )) target.window_backend   = node.value_or(target.window_backend);
+    else if ((section == "GENERAL") and (value == "text_left_margin")) target.text_left_margin = node.value_or(target.text_left_margin);
+    else if ((section == "GENERAL") and (value == "text_top1_margin")) target.text_top1_margin = node.value_or(target.text_top1_margin);
+    else if ((section == "GENERAL") and (value == "text_top2_margin")) target.text_top2_margin = node.value_or(target.text_top2_margin);
+    else if ((section == "GENERAL") and (value == "xft_fontname"    )) target.xft_fontname     = node.value_or(target.xft_fontname);
+    else if ((section == "GENERAL") and (value == "xft_fontsize"    )) target.xft_fontsize     = node.value_or(target.xft_fontsize);
+    else if ((section == "GENERAL") and (value == "match_mode"      )) target.match_mode       = node.value_or(target.match_mode);
+    else if ((section == "GENERAL") and (value == "trigram_index"   )) target.trigram_index    = node.value_or(target.trigram_index);
+    else if ((section == "GENERAL") and (value == "match_threads"   )) target.match_threads    = node.value_or(target.match_threads);
+    else if ((section == "GENERAL") and (value == "latency_stats"   )) target.latency_stats    = node.value_or(target.latency_stats);
+    else if ((section == "GENERAL") and (value == "latency_file"    )) target.latency_file     = node.value_or(target.latency_file);
     else if ((section == "GENERAL")                                  ) show_error_message(section, value);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Read the [PROVIDER] section.
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+
+    else if ((section == "PROVIDER") and (value == "deadline")) target.provider_deadline = node.value_or(target.provider_deadline);
+    else if ((section == "PROVIDER") and (value == "enabled" ))
+    {
+        // The order of the names is the priority of the providers.
+        target.providers.clear();
+
+        if (node.is_array())
+            for (const auto& elem : *node.as_array())
+                if (const auto name = elem.value<std::string>(); name)
+                    target.providers.push_back(*name);
+    }
+    else if ((section == "PROVIDER")                          ) show_error_message(section, value);
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Read the [ALIAS] section.
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,7 +106,7 @@ set_config(const toml::table& table, const toml::key& section, const toml::key&
         const std::string key = std::string(value.str());
         const std::string val = node.value_or("");
 
-        config.aliases[key] = val;
+        target.aliases[key] = val;
     }
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -98,26 +122,47 @@ set_config(const toml::table& table, const toml::key& section, const toml::key&
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void
-load_config(std::string filepath) noexcept
+init_config(Config& target) noexcept
+{   // {{{
+
+    // The [GENERAL] settings.
+    target.window_width     = 400;
+    target.window_height    = 80;
+    target.window_border    = 0;
+    target.window_title     = "HiRuGe: software launcher";
+    target.window_backend   = "xlib";
+    target.text_left_margin = 10;
+    target.text_top1_margin = 30;
+    target.text_top2_margin = 60;
+    target.xft_fontname     = "DejaVu Sans Mono";
+    target.xft_fontsize     = 14.0;
+    target.match_mode       = "prefix";
+    target.trigram_index    = false;
+    target.match_threads    = 0;
+    target.latency_stats    = false;
+    target.latency_file     = "auto";
+
+    // The [PROVIDER] settings.
+    target.providers         = {"path", "alias", "args", "files", "desktop", "history"};
+    target.provider_deadline = 10;
+
+    // The [ALIAS] settings.
+    target.aliases.clear();
+
+    // Not loaded from any file yet.
+    target.filepath.clear();
+
+}   // }}}
+
+bool
+load_config(std::string filepath, Config& target) noexcept
 {   // {{{
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Set default values
     ////////////////////////////////////////////////////////////////////////////////////////////////
 
-    // The [GENERAL] settings.
-    config.window_width     = 400;
-    config.window_height    = 80;
-    config.window_border    = 0;
-    config.window_title     = "HiRuGe: software launcher";
-    config.text_left_margin = 10;
-    config.text_top1_margin = 30;
-    config.text_top2_margin = 60;
-    config.xft_fontname     = "DejaVu Sans Mono";
-    config.xft_fontsize     = 14.0;
-
-    // The [ALIAS] settings.
-    config.aliases.clear();
+    init_config(target);
 
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Determine config file path
@@ -143,6 +188,10 @@ load_config(std::string filepath) noexcept
         else                                     { filepath = "config.toml";                              }
     }
 
+    // Memorize the config file path, which is watched in the resident mode.
+    std::error_code ec;
+    target.filepath = std::filesystem::absolute(filepath, ec).string();
+
     ////////////////////////////////////////////////////////////////////////////////////////////////
     // Read confg file
     ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -151,9 +200,9 @@ load_config(std::string filepath) noexcept
     toml::parse_result result = toml::parse_file(filepath);
     if (not result)
     {
-        std::cout << "\033[33mHiRuGe: Error occured while parsing config file: " << filepath << "\033[m\n";
-        std::cout << "\033[33mHiRuGe: " << result.error() << "\033[m" << std::endl;
-        return;
+        std::cerr << "\033[33mHiRuGe: Error occured while parsing config file: " << filepath << "\033[m\n";
+        std::cerr << "\033[33mHiRuGe: " << result.error() << "\033[m" << std::endl;
+        return false;
     }
 
     // Steal the table from the result.
@@ -168,9 +217,11 @@ load_config(std::string filepath) noexcept
         // If the node is a table then read the values contained in the table.
         if (node_section.second.is_table())
             for (auto node_value : *node_section.second.as_table())
-                set_config(table, node_section.first, node_value.first);
+                set_config(target, table, node_section.first, node_value.first);
     }
 
+    return true;
+
 }   // }}}
 
 // vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
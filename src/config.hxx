@@ -3,6 +3,7 @@
 ///                                                                                              ///
 /// This file provides:                                                                          ///
 ///   - the global variable `config` which stores configuration values for HiRuGe.               ///
+///   - the function `init_config` which sets the default values to a config.                    ///
 ///   - the function `load_config` which reads config file and update `config` variable.         ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -26,14 +27,27 @@ typedef struct
     int32_t     window_height;
     int32_t     window_border;
     std::string window_title;
+    std::string window_backend;
     int32_t     text_left_margin;
     int32_t     text_top1_margin;
     int32_t     text_top2_margin;
     std::string xft_fontname;
     double      xft_fontsize;
+    std::string match_mode;
+    bool        trigram_index;
+    int32_t     match_threads;
+    bool        latency_stats;
+    std::string latency_file;
+
+    // [PROVIDER] settings.
+    std::vector<std::string> providers;
+    int32_t                  provider_deadline;
 
     // [ALIAS] settings.
     std::map<std::string, std::string> aliases;
+
+    // Path to the loaded config file.
+    std::string filepath;
 }
 Config;
 
@@ -49,13 +63,27 @@ extern Config config;
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void
-load_config(const std::string filepath) noexcept;
+init_config(Config& target) noexcept;
+// [Abstract]
+//   Set the default values to the given config. This is useful for the library users who
+//   configure the completion without any config file.
+//
+// [Args]
+//   target (Config&): [OUT] Config values.
+
+bool
+load_config(const std::string filepath, Config& target = config) noexcept;
 // [Abstract]
 //   Load config file written in TOML format.
-//   The result will be stored in the global variable `config` that is declared in `config.cxx`.
+//   The result will be stored in the global variable `config` that is declared in `config.cxx`
+//   unless the other target is given. The default values are stored if failed to read the file.
 //
 // [Args]
-//   filepath (const std::string): [IN] Path to TOML file.
+//   filepath (const std::string): [IN]  Path to TOML file.
+//   target   (Config&)          : [OUT] Config values.
+//
+// [Returns]
+//   (bool): False if the file does not exist or cannot be parsed.
 
 #endif
 
@@ -0,0 +1,182 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: daemon.cxx                                                                  ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "daemon.hxx"
+
+// Include the headers of STL.
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+// Include POSIX headers.
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Request message to show the window.
+#define MSG_SHOW ("show\n")
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool
+get_socket_address(struct sockaddr_un& addr) noexcept
+// [Abstract]
+//   Compute the socket address "$XDG_RUNTIME_DIR/hiruge<DISPLAY>.sock". The directory "/tmp"
+//   and the user ID are used instead if XDG_RUNTIME_DIR is not defined.
+//
+// [Args]
+//   addr (struct sockaddr_un&): [OUT] Socket address.
+//
+// [Returns]
+//   (bool): False if the path is too long.
+//
+{   // {{{
+
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    const char* display = std::getenv("DISPLAY");
+
+    // The resident process is bound to the display, therefore the display name is a part of the path.
+    std::string suffix = (display != nullptr) ? display : "";
+    for (char& c : suffix)
+        if (c == '/') c = '_';
+
+    std::string path;
+    if ((runtime != nullptr) and (runtime[0] != '\0')) path = std::string(runtime) + "/hiruge" + suffix + ".sock";
+    else                                               path = "/tmp/hiruge-" + std::to_string(getuid()) + suffix + ".sock";
+
+    if (path.size() >= sizeof(addr.sun_path))
+        return false;
+
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    return true;
+
+}   // }}}
+
+static int32_t
+connect_daemon(void) noexcept
+// [Abstract]
+//   Connect to the socket of the resident process without sending any request.
+//
+// [Returns]
+//   (int32_t): File descriptor of the connected socket, or -1 if no process is listening.
+//
+{   // {{{
+
+    struct sockaddr_un addr;
+    if (not get_socket_address(addr))
+        return -1;
+
+    const int32_t fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    // Connection will be refused immediately if the socket file is stale.
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}   // }}}
+
+static bool
+daemon_alive(void) noexcept
+// [Abstract]
+//   Returns true if a resident process is listening on the socket. Nothing is written to the
+//   connection, therefore the resident process ignores it and does not show the window.
+//
+// [Returns]
+//   (bool): True if the resident process is running.
+//
+{   // {{{
+
+    const int32_t fd = connect_daemon();
+    if (fd < 0)
+        return false;
+
+    close(fd);
+    return true;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+open_daemon_socket(void) noexcept
+{   // {{{
+
+    struct sockaddr_un addr;
+    if (not get_socket_address(addr))
+        return -1;
+
+    // Remove the socket file only if no process is listening on it.
+    if (daemon_alive())
+        return -1;
+    unlink(addr.sun_path);
+
+    const int32_t fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+
+    if ((bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) or (listen(fd, 8) != 0))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+
+}   // }}}
+
+bool
+notify_daemon(void) noexcept
+{   // {{{
+
+    const int32_t fd = connect_daemon();
+    if (fd < 0)
+        return false;
+
+    const bool ok = (write(fd, MSG_SHOW, std::strlen(MSG_SHOW)) == static_cast<ssize_t>(std::strlen(MSG_SHOW)));
+
+    close(fd);
+    return ok;
+
+}   // }}}
+
+bool
+accept_daemon_request(const int32_t fd) noexcept
+{   // {{{
+
+    const int32_t conn = accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (conn < 0)
+        return false;
+
+    // The client writes the request immediately after the connection, so wait for it
+    // but never block the event loop for long.
+    struct timeval timeout = {0, 100000};
+    setsockopt(conn, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char buffer[16] = {0};
+    const ssize_t size = read(conn, buffer, sizeof(buffer) - 1);
+    close(conn);
+
+    return (size > 0) and (std::strncmp(buffer, MSG_SHOW, std::strlen(MSG_SHOW)) == 0);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
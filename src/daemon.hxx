@@ -0,0 +1,48 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: daemon.hxx                                                                  ///
+///                                                                                              ///
+/// This file provides the functions to communicate between the resident HiRuGe process that is  ///
+/// launched with "--daemon" option and the client processes through a Unix domain socket.       ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DAEMON_HXX
+#define DAEMON_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+open_daemon_socket(void) noexcept;
+// [Abstract]
+//   Create a listening socket of the resident process. A stale socket file left by a dead
+//   process will be removed.
+//
+// [Returns]
+//   (int32_t): File descriptor of the listening socket, or -1 if failed.
+
+bool
+notify_daemon(void) noexcept;
+// [Abstract]
+//   Ask the resident process to show the window.
+//
+// [Returns]
+//   (bool): True if the resident process received the request.
+
+bool
+accept_daemon_request(const int32_t fd) noexcept;
+// [Abstract]
+//   Accept and consume one request from a client.
+//
+// [Args]
+//   fd (const int32_t): [IN] File descriptor of the listening socket.
+//
+// [Returns]
+//   (bool): True if a request to show the window is received.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
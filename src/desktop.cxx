@@ -0,0 +1,614 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: desktop.cxx                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "desktop.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Magic number at the head of the desktop index file (8 bytes, includes format version).
+#define DESKTOP_MAGIC ("HRGDSK01")
+
+// File name of the desktop index.
+#define DESKTOP_FILENAME ("desktop.idx")
+
+// Interval of validating the index again while the process is resident [sec].
+#define DESKTOP_REFRESH_INTERVAL (30)
+
+// Interval of polling the cancellation while waiting for the index [msec].
+#define DESKTOP_POLL_INTERVAL (1)
+
+// Penalty of the score if the user input matches to the generic name or a keyword only.
+#define DESKTOP_FIELD_PENALTY (8)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The desktop index file has the following layout:
+//
+//   DesktopHeader                            (16 bytes)
+//   DesktopRecord[n_records]                 (40 bytes each)
+//   char[pool_size]: NUL terminated strings referred by the offsets above
+//
+// The invisible applications (e.g. NoDisplay) are also recorded with an empty name so that the
+// files are not parsed again.
+
+typedef struct
+{
+    char     magic[8];
+    uint32_t n_records;
+    uint32_t pool_size;
+}
+DesktopHeader;
+
+typedef struct
+{
+    int64_t  mtime_sec;
+    int64_t  mtime_nsec;
+    uint32_t path;
+    uint32_t name;
+    uint32_t generic;
+    uint32_t keywords;
+    uint32_t exec;
+    uint32_t reserved;
+}
+DesktopRecord;
+
+typedef struct
+{
+    std::string     path;
+    struct timespec mtime;
+    std::string     name;
+    std::string     generic;
+    std::string     keywords;
+    std::string     exec;
+}
+DesktopFile;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string
+get_index_path(void) noexcept
+// [Abstract]
+//   Returns the path to the desktop index file.
+//
+// [Returns]
+//   (std::string): "$XDG_CACHE_HOME/hiruge/desktop.idx" or "~/.cache/hiruge/desktop.idx".
+//
+{   // {{{
+
+    const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+    const char* home      = std::getenv("HOME");
+
+    std::filesystem::path root;
+    if      ((xdg_cache != nullptr) and (xdg_cache[0] != '\0')) root = std::filesystem::path(xdg_cache);
+    else if (home != nullptr)                                   root = std::filesystem::path(home) / ".cache";
+    else                                                        return std::string();
+
+    return (root / "hiruge" / DESKTOP_FILENAME).string();
+
+}   // }}}
+
+static std::vector<std::string>
+get_application_dirs(void) noexcept
+// [Abstract]
+//   Returns the directories of the desktop files in the order of the priority.
+//
+// [Returns]
+//   (std::vector<std::string>): "$XDG_DATA_HOME/applications" and "applications" of each
+//                               directory in "$XDG_DATA_DIRS" without duplication.
+//
+{   // {{{
+
+    const char* xdg_home = std::getenv("XDG_DATA_HOME");
+    const char* xdg_dirs = std::getenv("XDG_DATA_DIRS");
+    const char* home     = std::getenv("HOME");
+
+    std::vector<std::string> roots;
+    if      ((xdg_home != nullptr) and (xdg_home[0] != '\0')) roots.emplace_back(xdg_home);
+    else if (home != nullptr)                                 roots.emplace_back(std::string(home).append("/.local/share"));
+
+    const std::string dirs = ((xdg_dirs != nullptr) and (xdg_dirs[0] != '\0')) ? xdg_dirs : "/usr/local/share:/usr/share";
+    for (size_t pos = 0; pos <= dirs.size(); )
+    {
+        const size_t end = std::min(dirs.find(':', pos), dirs.size());
+        if (end > pos) roots.emplace_back(dirs.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    std::vector<std::string> result;
+    for (const std::string& root : roots)
+    {
+        const std::string path = (std::filesystem::path(root) / "applications").string();
+        if (std::find(result.begin(), result.end(), path) == result.end())
+            result.push_back(path);
+    }
+
+    return result;
+
+}   // }}}
+
+static std::string
+trim(const std::string& str) noexcept
+// [Abstract]
+//   Returns the given string without the leading and trailing white spaces.
+//
+// [Args]
+//   str (const std::string&): [IN] Target string.
+//
+// [Returns]
+//   (std::string): Trimmed string.
+//
+{   // {{{
+
+    const size_t first = str.find_first_not_of(" \t\r");
+    const size_t last  = str.find_last_not_of(" \t\r");
+
+    return (first == std::string::npos) ? std::string() : str.substr(first, last - first + 1);
+
+}   // }}}
+
+static std::string
+unescape(const std::string& value) noexcept
+// [Abstract]
+//   Returns the given value of the desktop file with the escape sequences ("\s", "\n", "\t",
+//   "\r" and "\\") replaced.
+//
+// [Args]
+//   value (const std::string&): [IN] Raw value.
+//
+// [Returns]
+//   (std::string): Unescaped value.
+//
+{   // {{{
+
+    std::string result;
+    result.reserve(value.size());
+
+    for (size_t pos = 0; pos < value.size(); ++pos)
+    {
+        if ((value[pos] != '\\') or (pos + 1 == value.size()))
+        {
+            result.push_back(value[pos]);
+            continue;
+        }
+
+        switch (value[++pos])
+        {
+            case 's':  result.push_back(' ');  break;
+            case 'n':  result.push_back('\n'); break;
+            case 't':  result.push_back('\t'); break;
+            case 'r':  result.push_back('\r'); break;
+            case '\\': result.push_back('\\'); break;
+            default:   result.push_back('\\'); result.push_back(value[pos]); break;
+        }
+    }
+
+    return result;
+
+}   // }}}
+
+static std::string
+strip_field_codes(const std::string& exec) noexcept
+// [Abstract]
+//   Returns the given Exec value without the field codes (e.g. "%U"), because no file is given
+//   to the launched application. The escaped percent sign "%%" is kept as "%".
+//
+// [Args]
+//   exec (const std::string&): [IN] Exec value.
+//
+// [Returns]
+//   (std::string): Command line.
+//
+{   // {{{
+
+    std::string result;
+    result.reserve(exec.size());
+
+    for (size_t pos = 0; pos < exec.size(); ++pos)
+    {
+        if (exec[pos] != '%')                                     result.push_back(exec[pos]);
+        else if ((pos + 1 < exec.size()) and (exec[++pos] == '%')) result.push_back('%');
+    }
+
+    return trim(result);
+
+}   // }}}
+
+static void
+parse_desktop_file(DesktopFile& file) noexcept
+// [Abstract]
+//   Read the values of the "[Desktop Entry]" group of the given file. The name is cleared if the
+//   entry is not a visible application.
+//
+// [Args]
+//   file (DesktopFile&): [IN/OUT] Desktop file whose path is set.
+//
+{   // {{{
+
+    std::ifstream stream(file.path);
+    std::string   line, type;
+    bool          group  = false;
+    bool          hidden = false;
+
+    while (std::getline(stream, line))
+    {
+        // Skip the empty lines and the comments.
+        if (line.empty() or (line[0] == '#'))
+            continue;
+
+        // Only the "[Desktop Entry]" group is read (the actions are ignored).
+        if (line[0] == '[')
+        {
+            group = (trim(line) == "[Desktop Entry]");
+            continue;
+        }
+
+        const size_t pos = line.find('=');
+        if ((not group) or (pos == std::string::npos))
+            continue;
+
+        // The localized values (e.g. "Name[ja]") are not used.
+        const std::string key   = trim(line.substr(0, pos));
+        const std::string value = unescape(trim(line.substr(pos + 1)));
+
+        if      (key == "Type"       ) type          = value;
+        else if (key == "Name"       ) file.name     = value;
+        else if (key == "GenericName") file.generic  = value;
+        else if (key == "Keywords"   ) file.keywords = value;
+        else if (key == "Exec"       ) file.exec     = strip_field_codes(value);
+        else if (key == "NoDisplay"  ) hidden       |= (value == "true");
+        else if (key == "Hidden"     ) hidden       |= (value == "true");
+    }
+
+    if ((type != "Application") or hidden or file.exec.empty())
+        file.name.clear();
+
+}   // }}}
+
+static void
+read_index(const std::string& filepath, std::unordered_map<std::string, DesktopFile>& target) noexcept
+// [Abstract]
+//   Read the desktop index file. Nothing is read if the file is broken.
+//
+// [Args]
+//   filepath (const std::string&)                           : [IN]  Path to the index file.
+//   target   (std::unordered_map<std::string, DesktopFile>&): [OUT] Desktop files indexed by the path.
+//
+{   // {{{
+
+    const int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    void*       addr = MAP_FAILED;
+    if ((fstat(fd, &st) == 0) and (static_cast<size_t>(st.st_size) >= sizeof(DesktopHeader)))
+        addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return;
+
+    const char*          base    = static_cast<const char*>(addr);
+    const DesktopHeader* header  = reinterpret_cast<const DesktopHeader*>(base);
+    const DesktopRecord* records = reinterpret_cast<const DesktopRecord*>(base + sizeof(DesktopHeader));
+
+    // Check the header and the file size.
+    bool valid = (std::memcmp(header->magic, DESKTOP_MAGIC, sizeof(header->magic)) == 0)
+             and (sizeof(DesktopHeader) + sizeof(DesktopRecord) * static_cast<size_t>(header->n_records) + header->pool_size == static_cast<size_t>(st.st_size))
+             and (header->pool_size > 0);
+
+    // Check that the strings in the pool are terminated and all offsets point inside the pool.
+    const char* pool = valid ? reinterpret_cast<const char*>(records + header->n_records) : nullptr;
+    valid = valid and (pool[header->pool_size - 1] == '\0');
+
+    for (uint32_t idx = 0; valid and (idx < header->n_records); ++idx)
+    {
+        const DesktopRecord& record = records[idx];
+        valid = std::max({record.path, record.name, record.generic, record.keywords, record.exec}) < header->pool_size;
+    }
+
+    for (uint32_t idx = 0; valid and (idx < header->n_records); ++idx)
+    {
+        const DesktopRecord& record = records[idx];
+        const struct timespec mtime = {static_cast<time_t>(record.mtime_sec), static_cast<long>(record.mtime_nsec)};
+
+        target[pool + record.path] = {pool + record.path, mtime, pool + record.name, pool + record.generic, pool + record.keywords, pool + record.exec};
+    }
+
+    munmap(addr, st.st_size);
+
+}   // }}}
+
+static void
+write_index(const std::string& filepath, const std::vector<DesktopFile>& files) noexcept
+// [Abstract]
+//   Write the desktop index file. The file is replaced atomically, therefore concurrent
+//   processes always see a complete index.
+//
+// [Args]
+//   filepath (const std::string&)             : [IN] Path to the index file.
+//   files    (const std::vector<DesktopFile>&): [IN] Parsed desktop files.
+//
+{   // {{{
+
+    std::string                pool;
+    std::vector<DesktopRecord> records;
+
+    // Append the given string to the pool and returns its offset.
+    auto append = [&pool](const std::string& str) -> uint32_t
+    {
+        const uint32_t offset = pool.size();
+        pool.append(str.c_str(), str.size() + 1);
+        return offset;
+    };
+
+    for (const DesktopFile& file : files)
+        records.push_back({file.mtime.tv_sec, file.mtime.tv_nsec, append(file.path), append(file.name), append(file.generic), append(file.keywords), append(file.exec), 0});
+
+    // Make sure that the pool is never empty.
+    if (pool.empty())
+        pool.push_back('\0');
+
+    DesktopHeader header;
+    std::memcpy(header.magic, DESKTOP_MAGIC, sizeof(header.magic));
+    header.n_records = records.size();
+    header.pool_size = pool.size();
+
+    // Write to a temporary file and rename it to the index file.
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(filepath).parent_path(), ec);
+
+    const std::string tmppath = filepath + "." + std::to_string(getpid());
+    std::ofstream     stream(tmppath, std::ios::binary | std::ios::trunc);
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(records.data()), sizeof(DesktopRecord) * records.size());
+    stream.write(pool.data(), pool.size());
+    stream.close();
+
+    if ((not stream) or (rename(tmppath.c_str(), filepath.c_str()) != 0))
+        unlink(tmppath.c_str());
+
+}   // }}}
+
+static std::vector<std::string>
+split_keywords(const std::string& keywords) noexcept
+// [Abstract]
+//   Split the given Keywords value by semicolons.
+//
+// [Args]
+//   keywords (const std::string&): [IN] Keywords value (e.g. "Internet;WWW;").
+//
+// [Returns]
+//   (std::vector<std::string>): Non-empty keywords.
+//
+{   // {{{
+
+    std::vector<std::string> result;
+
+    for (size_t pos = 0; pos < keywords.size(); )
+    {
+        const size_t end = std::min(keywords.find(';', pos), keywords.size());
+        if (end > pos) result.emplace_back(keywords.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    return result;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DesktopProvider::DesktopProvider(const Config& settings) : settings(settings), reload(false), stop(false)
+{   // {{{
+
+    // Start loading immediately, so that the index is usually ready before the first key input.
+    this->thread = std::thread(&DesktopProvider::run, this);
+
+}   // }}}
+
+DesktopProvider::~DesktopProvider(void)
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->stop = true;
+    }
+
+    this->cond.notify_all();
+    this->thread.join();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+DesktopProvider::query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    std::shared_ptr<const std::vector<DesktopEntry>> snapshot;
+
+    {
+        std::unique_lock<std::mutex> guard(this->mutex);
+
+        // Wait for the first load. The result is merged later if it misses the deadline.
+        while (this->entries == nullptr)
+        {
+            if (cancelled and cancelled())
+                return;
+
+            this->cond.wait_for(guard, std::chrono::milliseconds(DESKTOP_POLL_INTERVAL));
+        }
+
+        snapshot = this->entries;
+
+        // Validate the index again in background. The current one is used until then.
+        if ((not this->reload) and (std::chrono::steady_clock::now() - this->loaded > std::chrono::seconds(DESKTOP_REFRESH_INTERVAL)))
+        {
+            this->reload = true;
+            this->cond.notify_all();
+        }
+    }
+
+    std::string lower(input);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const char c) { return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c; });
+
+    for (const DesktopEntry& entry : *snapshot)
+    {
+        if (cancelled and cancelled())
+            return;
+
+        int32_t score;
+        bool    matched = match_label(input, lower, entry.name, score, this->settings);
+
+        // The generic name and the keywords are less relevant than the name.
+        auto match_field = [&](const std::string& field)
+        {
+            int32_t value;
+            if ((not matched) and match_label(input, lower, field, value, this->settings))
+            {
+                score   = value - DESKTOP_FIELD_PENALTY;
+                matched = true;
+            }
+        };
+
+        match_field(entry.generic);
+        for (const std::string& keyword : entry.keywords)
+            match_field(keyword);
+
+        if (matched)
+            items.push_back({entry.name, entry.exec, score});
+    }
+
+    // The applications are sorted by the name, which is kept for the same score.
+    std::stable_sort(items.begin(), items.end(), [](const ProviderItem& a, const ProviderItem& b) { return a.score > b.score; });
+
+    if (items.size() > PROVIDER_MAX_ITEMS)
+        items.resize(PROVIDER_MAX_ITEMS);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+DesktopProvider::run(void) noexcept
+{   // {{{
+
+    while (true)
+    {
+        auto loaded = std::make_shared<std::vector<DesktopEntry>>();
+        load_desktop_entries(*loaded);
+
+        {
+            std::unique_lock<std::mutex> guard(this->mutex);
+
+            this->entries = std::move(loaded);
+            this->loaded  = std::chrono::steady_clock::now();
+            this->reload  = false;
+
+            this->cond.notify_all();
+            this->cond.wait(guard, [this](void) { return this->stop or this->reload; });
+
+            if (this->stop)
+                return;
+        }
+    }
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+load_desktop_entries(std::vector<DesktopEntry>& target) noexcept
+{   // {{{
+
+    const std::string filepath = get_index_path();
+
+    // Read the parsed files of the previous run.
+    std::unordered_map<std::string, DesktopFile> cached;
+    if (not filepath.empty())
+        read_index(filepath, cached);
+
+    std::vector<DesktopFile>        files;
+    std::unordered_set<std::string> ids;
+    bool                            changed = false;
+
+    for (const std::string& dir : get_application_dirs())
+    {
+        std::error_code ec;
+        for (auto iter = std::filesystem::recursive_directory_iterator(dir, std::filesystem::directory_options::skip_permission_denied, ec);
+             (not ec) and (iter != std::filesystem::recursive_directory_iterator()); iter.increment(ec))
+        {
+            const std::filesystem::path& path = iter->path();
+            if (path.extension() != ".desktop")
+                continue;
+
+            // The desktop file ID is the relative path with "/" replaced by "-". The same ID in
+            // the later directories is shadowed even if it is hidden.
+            std::string id = path.lexically_relative(dir).string();
+            std::replace(id.begin(), id.end(), '/', '-');
+
+            struct stat st;
+            if ((stat(path.c_str(), &st) != 0) or (not S_ISREG(st.st_mode)) or (not ids.insert(id).second))
+                continue;
+
+            // Reuse the cached values if the file is not modified.
+            const auto found = cached.find(path.string());
+            if ((found != cached.end()) and (found->second.mtime.tv_sec == st.st_mtim.tv_sec) and (found->second.mtime.tv_nsec == st.st_mtim.tv_nsec))
+            {
+                files.push_back(std::move(found->second));
+                continue;
+            }
+
+            files.push_back({path.string(), st.st_mtim, {}, {}, {}, {}});
+            parse_desktop_file(files.back());
+            changed = true;
+        }
+    }
+
+    // Rewrite the index if any file is modified, added or removed.
+    if ((changed or (files.size() != cached.size())) and (not filepath.empty()))
+        write_index(filepath, files);
+
+    target.clear();
+    for (DesktopFile& file : files)
+        if (not file.name.empty())
+            target.push_back({std::move(file.name), std::move(file.generic), split_keywords(file.keywords), std::move(file.exec)});
+
+    std::sort(target.begin(), target.end(), [](const DesktopEntry& a, const DesktopEntry& b) { return a.name < b.name; });
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
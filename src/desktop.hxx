@@ -0,0 +1,125 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: desktop.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "DesktopProvider" class, the provider of the applications described   ///
+/// by the XDG ".desktop" files. The files are parsed on a background thread into the on-disk    ///
+/// index "$XDG_CACHE_HOME/hiruge/desktop.idx", which is validated by the modification time of   ///
+/// each file, and the applications are searched by Name, GenericName and Keywords.              ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DESKTOP_HXX
+#define DESKTOP_HXX
+
+// Include the headers of STL.
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include custom headers.
+#include "provider.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    std::string              name;      // Name of the application.
+    std::string              generic;   // Generic name of the application (e.g. "Web Browser").
+    std::vector<std::string> keywords;  // Keywords of the application.
+    std::string              exec;      // Command line without the field codes.
+} DesktopEntry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class DesktopProvider : public Provider
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         explicit DesktopProvider(const Config& settings);
+        ~DesktopProvider(void);
+        // [Abstract]
+        //   Construct the provider with the given config values, which must outlive this instance.
+        //   The index is loaded in background immediately.
+        //
+        // [Args]
+        //   settings (const Config&): [IN] Config values.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "provider.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept override;
+        // [Abstract]
+        //   Find the applications whose Name, GenericName or one of the Keywords matches to the
+        //   given user input. The matches of the name are preferred. The first query waits for
+        //   the index, and the index is validated again in background after a while.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const Config& settings;
+        // Config values (the matching mode).
+
+        std::mutex mutex;
+        // Mutex of the member variables except for "this->thread".
+
+        std::condition_variable cond;
+        // Condition variable notified when the index is loaded or a reload is requested.
+
+        std::shared_ptr<const std::vector<DesktopEntry>> entries;
+        // Applications sorted by the name (nullptr until loaded).
+
+        std::chrono::steady_clock::time_point loaded;
+        // Time when "this->entries" is loaded.
+
+        bool reload;
+        // True if the loader thread should validate the index again.
+
+        bool stop;
+        // True if the loader thread should exit.
+
+        std::thread thread;
+        // Thread loading the index.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        run(void) noexcept;
+        // [Abstract]
+        //   Main loop of the loader thread.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+load_desktop_entries(std::vector<DesktopEntry>& target) noexcept;
+// [Abstract]
+//   Get the visible applications in "$XDG_DATA_HOME/applications" and "applications" of each
+//   directory in "$XDG_DATA_DIRS". The earlier directory wins if the same desktop file ID is
+//   found in several directories. The parsed files are cached in the on-disk index, and only the
+//   files modified since the index was written are parsed again.
+//
+// [Args]
+//   target (std::vector<DesktopEntry>&): [OUT] Applications sorted by the name.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
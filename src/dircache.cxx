@@ -0,0 +1,228 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: dircache.cxx                                                                ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "dircache.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+
+// Include POSIX headers.
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Lifetime of the cached listing [msec]. The outdated listing is still used while it is read again.
+#define DIRCACHE_LIFETIME (2000)
+
+// Interval of polling the cancellation while waiting for a directory [msec].
+#define DIRCACHE_POLL_INTERVAL (1)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::shared_ptr<const Listing>
+read_directory(const std::string& path) noexcept
+// [Abstract]
+//   Read the files in the given directory. The file types are taken from the directory entries
+//   if possible, because "stat()" is slow on a network file system.
+//
+// [Args]
+//   path (const std::string&): [IN] Directory path.
+//
+// [Returns]
+//   (std::shared_ptr<const Listing>): Files sorted by the name (empty if failed to read).
+//
+{   // {{{
+
+    auto listing = std::make_shared<Listing>();
+
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr)
+        return listing;
+
+    while (const struct dirent* entry = readdir(dir))
+    {
+        const std::string name(entry->d_name);
+        if ((name == ".") or (name == ".."))
+            continue;
+
+        bool directory  = (entry->d_type == DT_DIR);
+        bool executable = false;
+
+        // The symbolic links and the regular files need the attributes of the target.
+        if ((entry->d_type == DT_LNK) or (entry->d_type == DT_REG) or (entry->d_type == DT_UNKNOWN))
+        {
+            struct stat st;
+            if (fstatat(dirfd(dir), entry->d_name, &st, 0) == 0)
+            {
+                directory  = S_ISDIR(st.st_mode);
+                executable = S_ISREG(st.st_mode) and ((st.st_mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
+            }
+        }
+
+        listing->push_back({name, directory, executable});
+    }
+
+    closedir(dir);
+
+    std::sort(listing->begin(), listing->end(), [](const DirectoryItem& a, const DirectoryItem& b) { return a.name < b.name; });
+
+    return listing;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DirectoryCache::DirectoryCache(const size_t capacity) : capacity(std::max<size_t>(capacity, 1)), stop(false)
+{   // {{{
+
+    this->thread = std::thread(&DirectoryCache::run, this);
+
+}   // }}}
+
+DirectoryCache::~DirectoryCache(void)
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->stop = true;
+    }
+
+    this->queue_cond.notify_all();
+    this->thread.join();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<const Listing>
+DirectoryCache::wait(const std::string& path, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    std::unique_lock<std::mutex> guard(this->mutex);
+
+    while (true)
+    {
+        const auto iter = this->index.find(path);
+
+        if (iter != this->index.end())
+        {
+            // Move to the most recently used position.
+            this->entries.splice(this->entries.begin(), this->entries, iter->second);
+
+            if (std::chrono::steady_clock::now() - iter->second->listed > std::chrono::milliseconds(DIRCACHE_LIFETIME))
+                this->enqueue(path, false);
+
+            return iter->second->listing;
+        }
+
+        this->enqueue(path, true);
+
+        if (cancelled and cancelled())
+            return nullptr;
+
+        this->listed_cond.wait_for(guard, std::chrono::milliseconds(DIRCACHE_POLL_INTERVAL));
+    }
+
+}   // }}}
+
+void
+DirectoryCache::prefetch(const std::string& path) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    if (this->index.find(path) == this->index.end())
+        this->enqueue(path, false);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+DirectoryCache::enqueue(const std::string& path, const bool urgent) noexcept
+{   // {{{
+
+    const auto iter = std::find(this->queue.begin(), this->queue.end(), path);
+
+    // The waited directory is moved to the head even if it is already queued as a prefetch.
+    if (iter != this->queue.end())
+    {
+        if ((not urgent) or (iter == this->queue.begin()))
+            return;
+
+        this->queue.erase(iter);
+    }
+
+    if (urgent) this->queue.push_front(path);
+    else        this->queue.push_back(path);
+
+    this->queue_cond.notify_one();
+
+}   // }}}
+
+void
+DirectoryCache::run(void) noexcept
+{   // {{{
+
+    while (true)
+    {
+        std::string path;
+
+        {
+            std::unique_lock<std::mutex> guard(this->mutex);
+            this->queue_cond.wait(guard, [this](void) { return this->stop or (not this->queue.empty()); });
+
+            if (this->stop)
+                return;
+
+            // Keep the path in the queue while reading so that it is not queued twice.
+            path = this->queue.front();
+        }
+
+        std::shared_ptr<const Listing> listing = read_directory(path);
+
+        {
+            std::lock_guard<std::mutex> guard(this->mutex);
+
+            this->queue.erase(std::find(this->queue.begin(), this->queue.end(), path));
+
+            const auto iter = this->index.find(path);
+            if (iter != this->index.end())
+            {
+                iter->second->listing = std::move(listing);
+                iter->second->listed  = std::chrono::steady_clock::now();
+            }
+            else
+            {
+                this->entries.push_front({path, std::move(listing), std::chrono::steady_clock::now()});
+                this->index[path] = this->entries.begin();
+            }
+
+            // Evict the least recently used directories.
+            while (this->entries.size() > this->capacity)
+            {
+                this->index.erase(this->entries.back().path);
+                this->entries.pop_back();
+            }
+        }
+
+        this->listed_cond.notify_all();
+    }
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
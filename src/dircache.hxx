@@ -0,0 +1,143 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: dircache.hxx                                                                ///
+///                                                                                              ///
+/// This file provides the "DirectoryCache" class, an LRU cache of directory listings which are  ///
+/// read on a background thread, so that a slow file system (e.g. NFS) never blocks the caller.  ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef DIRCACHE_HXX
+#define DIRCACHE_HXX
+
+// Include the headers of STL.
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    std::string name;        // File name.
+    bool        directory;   // True if the file is a directory or a symbolic link to it.
+    bool        executable;  // True if the file is an executable regular file.
+} DirectoryItem;
+
+typedef std::vector<DirectoryItem> Listing;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class DirectoryCache
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         explicit DirectoryCache(const size_t capacity);
+        ~DirectoryCache(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::shared_ptr<const Listing>
+        wait(const std::string& path, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Returns the listing of the given directory. If the directory is not cached, it is
+        //   read by the background thread and this function waits for it. An outdated listing is
+        //   returned immediately and read again in background. This function is thread safe.
+        //
+        // [Args]
+        //   path      (const std::string&)              : [IN] Directory path.
+        //   cancelled (const std::function<bool(void)>&): [IN] Polled while waiting.
+        //
+        // [Returns]
+        //   (std::shared_ptr<const Listing>): Files sorted by the name (empty if failed to read),
+        //                                     or nullptr if cancelled.
+
+        void
+        prefetch(const std::string& path) noexcept;
+        // [Abstract]
+        //   Read the given directory in background if it is not cached. The prefetch is queued
+        //   after the directories waited by "wait()".
+        //
+        // [Args]
+        //   path (const std::string&): [IN] Directory path.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private data types
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        typedef struct {
+            std::string                           path;     // Directory path.
+            std::shared_ptr<const Listing>        listing;  // Files in the directory.
+            std::chrono::steady_clock::time_point listed;   // Time when the directory is read.
+        } Entry;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        size_t capacity;
+        // Maximum number of the cached directories.
+
+        std::list<Entry> entries;
+        // Cached directories in the order of the recent use.
+
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        // Cached directories indexed by the path.
+
+        std::deque<std::string> queue;
+        // Directories to be read by the background thread.
+
+        std::mutex mutex;
+        // Mutex of the all member variables except for "this->thread".
+
+        std::condition_variable queue_cond;
+        // Condition variable notified when a directory is queued or the thread should exit.
+
+        std::condition_variable listed_cond;
+        // Condition variable notified when a directory is read.
+
+        bool stop;
+        // True if the background thread should exit.
+
+        std::thread thread;
+        // Thread reading the directories.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        enqueue(const std::string& path, const bool urgent) noexcept;
+        // [Abstract]
+        //   Queue the given directory if it is not queued yet. Must be called under "this->mutex".
+        //
+        // [Args]
+        //   path   (const std::string&): [IN] Directory path.
+        //   urgent (const bool)        : [IN] True if someone waits for the directory.
+
+        void
+        run(void) noexcept;
+        // [Abstract]
+        //   Main loop of the background thread.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: files.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "files.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdlib>
+
+// Include custom headers.
+#include "spawn.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum number of the cached directory listings.
+#define FILES_CACHE_CAPACITY (64)
+
+// Number of the best matched directories to be prefetched.
+#define FILES_PREFETCH (2)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+FileProvider::FileProvider(const Config& settings) : settings(settings), cache(FILES_CACHE_CAPACITY)
+{   // {{{
+
+    const char* home = std::getenv("HOME");
+    this->home = (home != nullptr) ? home : "";
+
+    // The current directory and the home directory are the most likely starting points.
+    this->cache.prefetch(".");
+    if (not this->home.empty())
+        this->cache.prefetch(this->home);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+FileProvider::query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    // The path being typed is the last word of the command line. The words are split in the
+    // same way as "spawn_command()", so that a quoted or escaped white space is a part of the path.
+    std::vector<std::string> words;
+    const size_t start = split_words(input, words);
+    const bool   typing = (start < input.size());
+
+    const bool        argument = (words.size() > (typing ? 1 : 0));
+    const std::string word     = typing ? words.back() : std::string();
+
+    // The command name is completed by the other providers unless it is typed as a path.
+    if ((not argument) and (word.empty() or ((word[0] != '/') and (word[0] != '~') and (word[0] != '.'))))
+        return;
+
+    // Split the path into the directory part (with the trailing slash) and the typed name.
+    const size_t      slash = word.rfind('/');
+    const std::string dir   = (slash == std::string::npos) ? std::string() : word.substr(0, slash + 1);
+    const std::string name  = word.substr(dir.size());
+
+    // The command typed as a path needs a directory, e.g. "~" is not completed until "~/".
+    if ((not argument) and dir.empty())
+        return;
+
+    // Expand the leading "~" unless it is quoted. The relative paths are relative to the current
+    // directory, which is also the working directory of the launched process.
+    const bool  tilde = typing and (input[start] == '~') and (not dir.empty()) and (dir[1] == '/');
+    std::string path  = dir.empty() ? std::string(".") : dir;
+    if (tilde and (not this->home.empty()))
+        path = this->home + path.substr(1);
+
+    // Directory part of the labels, which is quoted again after the "~".
+    const std::string typed = dir.substr(tilde ? 2 : 0);
+
+    // The listing of a slow file system is merged later by the provider deadline.
+    const std::shared_ptr<const Listing> listing = this->cache.wait(path, cancelled);
+    if (listing == nullptr)
+        return;
+
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const char c) { return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c; });
+
+    // Indices of the matched items in the listing, which is parallel to "items".
+    std::vector<size_t> matched;
+
+    for (size_t idx = 0; idx < listing->size(); ++idx)
+    {
+        const DirectoryItem& item = (*listing)[idx];
+
+        // The hidden files are shown only if the name starts with a dot.
+        if ((item.name[0] == '.') and ((name.empty()) or (name[0] != '.')))
+            continue;
+
+        // Only the directories and the executables can be a command.
+        if ((not argument) and (not item.directory) and (not item.executable))
+            continue;
+
+        int32_t score = 0;
+        if ((not name.empty()) and (not match_label(name, lower, item.name, score, this->settings)))
+            continue;
+
+        // The completed path is escaped except for the leading "~", so that a name with white
+        // spaces or shell syntax is given to the command as one literal word.
+        std::string label = input.substr(0, start);
+        label.append(tilde ? "~/" : "").append(typed.empty() ? std::string() : quote_word(typed));
+        label.append(quote_word(item.name)).append(item.directory ? "/" : "");
+
+        items.push_back({label, label, score});
+        matched.push_back(idx);
+
+        if (cancelled and cancelled())
+            return;
+    }
+
+    // The listing is sorted by the name, which is kept for the same score.
+    std::vector<size_t> order(items.size());
+    for (size_t idx = 0; idx < order.size(); ++idx)
+        order[idx] = idx;
+
+    std::stable_sort(order.begin(), order.end(), [&items](const size_t a, const size_t b) { return items[a].score > items[b].score; });
+
+    if (order.size() > PROVIDER_MAX_ITEMS)
+        order.resize(PROVIDER_MAX_ITEMS);
+
+    std::vector<ProviderItem> best;
+    size_t                    n_prefetched = 0;
+
+    for (const size_t idx : order)
+    {
+        // Prefetch the directories which the user is likely to navigate into.
+        const DirectoryItem& item = (*listing)[matched[idx]];
+        if (item.directory and (n_prefetched++ < FILES_PREFETCH))
+            this->cache.prefetch(std::string(path).append(path.back() == '/' ? "" : "/").append(item.name).append("/"));
+
+        best.push_back(std::move(items[idx]));
+    }
+
+    items.swap(best);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,70 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: files.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the "FileProvider" class, the provider of the file paths. The last word   ///
+/// of the user input is completed as a path if the input has arguments (e.g. "vim ~/wo"), and   ///
+/// the whole input is completed as a command if it starts with "/", "~" or "." (e.g. "./run").  ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FILES_HXX
+#define FILES_HXX
+
+// Include the headers of STL.
+#include <string>
+#include <vector>
+
+// Include custom headers.
+#include "dircache.hxx"
+#include "provider.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class FileProvider : public Provider
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        explicit FileProvider(const Config& settings);
+        // [Abstract]
+        //   Construct the provider with the given config values, which must outlive this instance.
+        //   The current directory and the home directory are prefetched.
+        //
+        // [Args]
+        //   settings (const Config&): [IN] Config values.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "provider.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept override;
+        // [Abstract]
+        //   Find the files in the directory of the path being typed whose name matches to the
+        //   last component of the path. The label is the whole command line with the completed
+        //   path, which ends with "/" for a directory. The directories of the best matches are
+        //   prefetched because the user is likely to navigate into them.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const Config& settings;
+        // Config values (the matching mode).
+
+        DirectoryCache cache;
+        // Listings of the recently used directories.
+
+        std::string home;
+        // Home directory which replaces "~".
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: fuzzy.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "fuzzy.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+
+// Include SIMD intrinsics.
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Score of one matched character.
+#define SCORE_MATCH (16)
+
+// Bonus of a match at the beginning of the name.
+#define BONUS_FIRST (12)
+
+// Bonus of a match at a word boundary (after '-', '_', '.', etc., or camelCase and digits).
+#define BONUS_BOUNDARY (8)
+
+// Bonus of a match that immediately follows the previous match.
+#define BONUS_CONSECUTIVE (8)
+
+// Bonus of a match with the same case.
+#define BONUS_CASE (1)
+
+// Penalty of a gap between matches (start and extension).
+#define PENALTY_GAP_START (3)
+#define PENALTY_GAP_EXT   (1)
+
+// Max penalty of the characters before the first match.
+#define PENALTY_LEADING_MAX (3)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool
+is_boundary(const char* name, const size_t pos) noexcept
+// [Abstract]
+//   Returns true if the given position is the beginning of a word.
+//
+// [Args]
+//   name (const char*) : [IN] Command name.
+//   pos  (const size_t): [IN] Position in the name.
+//
+// [Returns]
+//   (bool): True if the position is a word boundary.
+//
+{   // {{{
+
+    if (pos == 0)
+        return true;
+
+    const char prev = name[pos - 1];
+    const char curr = name[pos];
+
+    if ((prev == '-') or (prev == '_') or (prev == '.') or (prev == ' ') or (prev == '/') or (prev == '+'))
+        return true;
+
+    // camelCase and the beginning of a number.
+    if ((('a' <= prev) and (prev <= 'z')) and (('A' <= curr) and (curr <= 'Z')))
+        return true;
+    if ((not (('0' <= prev) and (prev <= '9'))) and (('0' <= curr) and (curr <= '9')))
+        return true;
+
+    return false;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t
+fuzzy_find(const char* buffer, size_t pos, const char c) noexcept
+{   // {{{
+
+#if defined(__AVX2__)
+
+    const __m256i vc = _mm256_set1_epi8(c);
+    const __m256i vz = _mm256_setzero_si256();
+
+    while (true)
+    {
+        const __m256i  v    = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buffer + pos));
+        const uint32_t mask = _mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(v, vc), _mm256_cmpeq_epi8(v, vz)));
+
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+
+        pos += 32;
+    }
+
+#elif defined(__SSE2__)
+
+    const __m128i vc = _mm_set1_epi8(c);
+    const __m128i vz = _mm_setzero_si128();
+
+    while (true)
+    {
+        const __m128i  v    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buffer + pos));
+        const uint32_t mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, vc), _mm_cmpeq_epi8(v, vz)));
+
+        if (mask != 0)
+            return pos + __builtin_ctz(mask);
+
+        pos += 16;
+    }
+
+#else
+
+    while ((buffer[pos] != c) and (buffer[pos] != '\0'))
+        ++pos;
+
+    return pos;
+
+#endif
+
+}   // }}}
+
+bool
+fuzzy_match(const char* lower, const std::string& query_lower, size_t& end) noexcept
+{   // {{{
+
+    size_t pos = 0;
+
+    for (const char c : query_lower)
+    {
+        pos = fuzzy_find(lower, pos, c);
+
+        if (lower[pos] == '\0')
+            return false;
+
+        end = pos++;
+    }
+
+    return true;
+
+}   // }}}
+
+int32_t
+fuzzy_bound(const std::string& query) noexcept
+{   // {{{
+
+    // Every character matches with the same case, the first character matches at the beginning
+    // of the name, and all the other characters are consecutive and at word boundaries.
+    const int32_t n = query.size();
+    return n * (SCORE_MATCH + BONUS_CASE) + BONUS_FIRST + std::max(n - 1, 0) * (BONUS_BOUNDARY + BONUS_CONSECUTIVE);
+
+}   // }}}
+
+int32_t
+fuzzy_score(const char* name, const char* lower, const size_t end, const std::string& query,
+            const std::string& query_lower) noexcept
+{   // {{{
+
+    const size_t n = query_lower.size();
+
+    // Find the shortest match that ends at the end of the leftmost match by searching backward,
+    // and compute the score of each matched character on the way.
+    int32_t score = 0;
+    size_t  next  = end + 1;
+
+    for (size_t i = end + 1, j = n; (i > 0) and (j > 0); --i)
+    {
+        if (lower[i - 1] != query_lower[j - 1])
+            continue;
+
+        const size_t pos = i - 1;
+        --j;
+
+        score += SCORE_MATCH;
+
+        if      (pos == 0)               score += BONUS_FIRST;
+        else if (is_boundary(name, pos)) score += BONUS_BOUNDARY;
+
+        if (j + 1 < n)
+        {
+            if (next == pos + 1) score += BONUS_CONSECUTIVE;
+            else                 score -= PENALTY_GAP_START + PENALTY_GAP_EXT * static_cast<int32_t>(next - pos - 2);
+        }
+
+        if (name[pos] == query[j])
+            score += BONUS_CASE;
+
+        next = pos;
+    }
+
+    // Penalty of the characters before the first match.
+    score -= static_cast<int32_t>(std::min<size_t>(next, PENALTY_LEADING_MAX));
+
+    return score;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: fuzzy.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the kernel functions of the fuzzy (subsequence) matching. The command     ///
+/// names are expected to be stored in a contiguous lower case buffer where each name is         ///
+/// terminated by NUL and the whole buffer is followed by FUZZY_PADDING bytes of NUL.            ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef FUZZY_HXX
+#define FUZZY_HXX
+
+// Include the headers of STL.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Number of NUL bytes required after the buffer, because the kernel reads the buffer by blocks.
+#define FUZZY_PADDING (32)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+size_t
+fuzzy_find(const char* buffer, size_t pos, const char c) noexcept;
+// [Abstract]
+//   Returns the position of the first character that is the given character or NUL at or after
+//   the given position. The search is done by SSE2/AVX2 byte comparisons if available.
+//
+// [Args]
+//   buffer (const char*) : [IN] Contiguous name buffer.
+//   pos    (size_t)      : [IN] Start position of the search.
+//   c      (const char)  : [IN] Character to be searched (must not be NUL).
+//
+// [Returns]
+//   (size_t): Position of the found character.
+
+bool
+fuzzy_match(const char* lower, const std::string& query_lower, size_t& end) noexcept;
+// [Abstract]
+//   Returns true if the given lower case name in the name buffer contains the query as
+//   a subsequence.
+//
+// [Args]
+//   lower       (const char*)       : [IN]  Lower case command name in the name buffer.
+//   query_lower (const std::string&): [IN]  Lower case user input (must not be empty).
+//   end         (size_t&)           : [OUT] Position of the last character of the leftmost match.
+//
+// [Returns]
+//   (bool): True if matched.
+
+int32_t
+fuzzy_bound(const std::string& query) noexcept;
+// [Abstract]
+//   Returns the upper bound of the score of the given query.
+//
+// [Args]
+//   query (const std::string&): [IN] User input.
+//
+// [Returns]
+//   (int32_t): Upper bound of "fuzzy_score".
+
+int32_t
+fuzzy_score(const char* name, const char* lower, const size_t end, const std::string& query,
+            const std::string& query_lower) noexcept;
+// [Abstract]
+//   Compute the matching score of the given name that contains the query as a subsequence.
+//   The score prefers the matches at word boundaries, contiguous matches, and the matches
+//   of the same case.
+//
+// [Args]
+//   name        (const char*)       : [IN] Command name.
+//   lower       (const char*)       : [IN] Lower case command name.
+//   end         (const size_t)      : [IN] Position of the last character of the leftmost match.
+//   query       (const std::string&): [IN] User input.
+//   query_lower (const std::string&): [IN] Lower case user input.
+//
+// [Returns]
+//   (int32_t): Score of the match (larger is better).
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
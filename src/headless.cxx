@@ -0,0 +1,314 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: headless.cxx                                                                ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "headless.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <chrono>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <unistd.h>
+
+// Include custom headers.
+#include "config.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline bool
+is_continuation(const char c) noexcept
+// [Abstract]
+//   Returns true if the given byte is a continuation byte of UTF-8.
+//
+// [Args]
+//   c (const char): [IN] Byte of UTF-8 text.
+//
+// [Returns]
+//   (bool): True or false.
+//
+{   // {{{
+
+    return (static_cast<uint8_t>(c) & 0xC0) == 0x80;
+
+}   // }}}
+
+static uint8_t
+read_glyph(const char* text, const size_t size, size_t& pos) noexcept
+// [Abstract]
+//   Read one UTF-8 character from the given position, and returns the code of its glyph.
+//
+// [Args]
+//   text (const char*) : [IN]     UTF-8 text.
+//   size (const size_t): [IN]     Size of the text in bytes.
+//   pos  (size_t&)     : [IN/OUT] Position of the first byte, which is moved to the next character.
+//
+// [Returns]
+//   (uint8_t): ASCII code, or 0x80 plus the lower 7 bits of the code point.
+//
+{   // {{{
+
+    const uint8_t lead = static_cast<uint8_t>(text[pos++]);
+    if (lead < 0x80)
+        return lead;
+
+    uint32_t code = (lead >= 0xF0) ? (lead & 0x07) : (lead >= 0xE0) ? (lead & 0x0F) : (lead & 0x1F);
+    while ((pos < size) and is_continuation(text[pos]))
+        code = (code << 6) | (static_cast<uint8_t>(text[pos++]) & 0x3F);
+
+    return static_cast<uint8_t>(0x80 | (code & 0x7F));
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+HeadlessBackend::HeadlessBackend(void)
+    : buffer(static_cast<size_t>(config.window_width) * config.window_height, 0),
+      screen(static_cast<size_t>(config.window_width) * config.window_height, 0),
+      shown(false), pipe_fds{-1, -1}
+{   // {{{
+
+    if (pipe2(this->pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0)
+        this->pipe_fds[0] = this->pipe_fds[1] = -1;
+
+}   // }}}
+
+HeadlessBackend::~HeadlessBackend(void)
+{   // {{{
+
+    if (this->pipe_fds[0] >= 0) close(this->pipe_fds[0]);
+    if (this->pipe_fds[1] >= 0) close(this->pipe_fds[1]);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+HeadlessBackend::pending(void) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return not this->events.empty();
+
+}   // }}}
+
+void
+HeadlessBackend::next_event(BackendEvent& event) noexcept
+{   // {{{
+
+    std::unique_lock<std::mutex> guard(this->mutex);
+    this->event_cond.wait(guard, [this](void) { return not this->events.empty(); });
+
+    event = this->events.front();
+    this->events.pop_front();
+
+    // Make the self-pipe unreadable when the queue becomes empty.
+    char byte;
+    if (this->events.empty() and (read(this->pipe_fds[0], &byte, 1) < 0)) {}
+
+}   // }}}
+
+void
+HeadlessBackend::map(void) noexcept
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->shown = true;
+    }
+
+    // Like the X server, the whole window is exposed when it is mapped.
+    this->push_event({EVENT_EXPOSE, 0, {0, 0, config.window_width, config.window_height}});
+
+}   // }}}
+
+void
+HeadlessBackend::unmap(void) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    this->shown = false;
+
+}   // }}}
+
+int32_t
+HeadlessBackend::text_width(const char* text, const size_t size) noexcept
+{   // {{{
+
+    return HEADLESS_GLYPH_WIDTH * std::count_if(text, text + size, [](const char c) { return not is_continuation(c); });
+
+}   // }}}
+
+void
+HeadlessBackend::fill(const Rect& rect) noexcept
+{   // {{{
+
+    const int32_t x1 = std::max(rect.x, 0), x2 = std::min(rect.x + rect.width,  config.window_width);
+    const int32_t y1 = std::max(rect.y, 0), y2 = std::min(rect.y + rect.height, config.window_height);
+
+    for (int32_t y = y1; y < y2; ++y)
+        std::fill(this->buffer.begin() + y * config.window_width + x1, this->buffer.begin() + y * config.window_width + std::max(x1, x2), (COLOR_BLACK << 8));
+
+}   // }}}
+
+void
+HeadlessBackend::draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept
+{   // {{{
+
+    const int32_t y1 = std::max(baseline - HEADLESS_ASCENT,  0);
+    const int32_t y2 = std::min(baseline + HEADLESS_DESCENT, config.window_height);
+
+    int32_t left = x;
+
+    for (size_t pos = 0; pos < size; )
+    {
+        if (is_continuation(text[pos]))
+        {
+            ++pos;
+            continue;
+        }
+
+        // Each glyph is a box of the character and the color.
+        const uint8_t  code  = read_glyph(text, size, pos);
+        const uint16_t pixel = static_cast<uint16_t>((color << 8) | code);
+        const int32_t  x1    = std::max(left, 0);
+        const int32_t  x2    = std::min(left + HEADLESS_GLYPH_WIDTH, config.window_width);
+
+        for (int32_t y = y1; (y < y2) and (x1 < x2); ++y)
+            std::fill(this->buffer.begin() + y * config.window_width + x1, this->buffer.begin() + y * config.window_width + x2, pixel);
+
+        left += HEADLESS_GLYPH_WIDTH;
+    }
+
+}   // }}}
+
+void
+HeadlessBackend::present(const Rect& rect) noexcept
+{   // {{{
+
+    if (rect.width <= 0)
+        return;
+
+    const int32_t x1 = std::max(rect.x, 0), x2 = std::min(rect.x + rect.width,  config.window_width);
+    const int32_t y1 = std::max(rect.y, 0), y2 = std::min(rect.y + rect.height, config.window_height);
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+
+        for (int32_t y = y1; (y < y2) and (x1 < x2); ++y)
+            std::copy(this->buffer.begin() + y * config.window_width + x1, this->buffer.begin() + y * config.window_width + x2, this->screen.begin() + y * config.window_width + x1);
+    }
+
+    this->frame_cond.notify_all();
+
+}   // }}}
+
+void
+HeadlessBackend::push_key(const char key) noexcept
+{   // {{{
+
+    this->push_event({EVENT_KEY, key, {0, 0, 0, 0}});
+
+}   // }}}
+
+std::string
+HeadlessBackend::text(const int32_t baseline) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return this->read_text(baseline);
+
+}   // }}}
+
+std::string
+HeadlessBackend::glyphs(const std::string_view text) noexcept
+{   // {{{
+
+    std::string result;
+
+    for (size_t pos = 0; pos < text.size(); )
+    {
+        if (is_continuation(text[pos])) ++pos;
+        else                            result.push_back(static_cast<char>(read_glyph(text.data(), text.size(), pos)));
+    }
+
+    return result;
+
+}   // }}}
+
+bool
+HeadlessBackend::wait_text(const std::vector<std::pair<int32_t, std::string>>& expected, const int64_t timeout_usec) noexcept
+{   // {{{
+
+    std::unique_lock<std::mutex> guard(this->mutex);
+
+    return this->frame_cond.wait_for(guard, std::chrono::microseconds(timeout_usec), [this, &expected](void)
+    {
+        for (const auto& [baseline, text] : expected)
+            if (this->read_text(baseline) != text)
+                return false;
+
+        return true;
+    });
+
+}   // }}}
+
+bool
+HeadlessBackend::mapped(void) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    return this->shown;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+HeadlessBackend::push_event(const BackendEvent& event) noexcept
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+
+        // Make the self-pipe readable when the queue becomes non-empty.
+        const char byte = 0;
+        if (this->events.empty() and (write(this->pipe_fds[1], &byte, 1) < 0)) {}
+
+        this->events.push_back(event);
+    }
+
+    this->event_cond.notify_one();
+
+}   // }}}
+
+std::string
+HeadlessBackend::read_text(const int32_t baseline) const noexcept
+{   // {{{
+
+    std::string result;
+
+    if ((baseline < 1) or (baseline > config.window_height))
+        return result;
+
+    // Sample the row just above the baseline at the left edge of each glyph.
+    const uint16_t* row = this->screen.data() + (baseline - 1) * config.window_width;
+
+    for (int32_t x = config.text_left_margin; (x >= 0) and (x < config.window_width) and ((row[x] & 0xFF) != 0); x += HEADLESS_GLYPH_WIDTH)
+        result.push_back(static_cast<char>(row[x] & 0xFF));
+
+    return result;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: headless.hxx                                                                ///
+///                                                                                              ///
+/// This file provides the "HeadlessBackend" class, the backend of the main window without the   ///
+/// window system. The key events are injected by the caller, and the text is rendered into an   ///
+/// in-memory buffer with a fixed width font so that the window contents can be read back.       ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HEADLESS_HXX
+#define HEADLESS_HXX
+
+// Include the headers of STL.
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Include custom headers.
+#include "backend.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Metrics of the glyphs of the headless font in pixels.
+#define HEADLESS_GLYPH_WIDTH (8)
+#define HEADLESS_ASCENT      (12)
+#define HEADLESS_DESCENT     (4)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class HeadlessBackend : public Backend
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         HeadlessBackend(void);
+        ~HeadlessBackend(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "backend.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        int32_t
+        fd(void) const noexcept override { return this->pipe_fds[0]; }
+
+        bool
+        pending(void) noexcept override;
+
+        void
+        next_event(BackendEvent& event) noexcept override;
+
+        void
+        set_title(int32_t, char**) noexcept override {}
+
+        void
+        map(void) noexcept override;
+
+        void
+        unmap(void) noexcept override;
+
+        void
+        flush(void) noexcept override {}
+
+        int32_t
+        ascent(void) const noexcept override { return HEADLESS_ASCENT; }
+
+        int32_t
+        descent(void) const noexcept override { return HEADLESS_DESCENT; }
+
+        int32_t
+        max_advance(void) const noexcept override { return HEADLESS_GLYPH_WIDTH; }
+
+        int32_t
+        text_width(const char* text, const size_t size) noexcept override;
+
+        void
+        fill(const Rect& rect) noexcept override;
+
+        void
+        draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept override;
+
+        void
+        present(const Rect& rect) noexcept override;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (headless only)
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        push_key(const char key) noexcept;
+        // [Abstract]
+        //   Queue a key event. This function can be called from any thread.
+        //
+        // [Args]
+        //   key (const char): [IN] Pressed key ('\r', 27 for escape and 8 for backspace).
+
+        std::string
+        text(const int32_t baseline) noexcept;
+        // [Abstract]
+        //   Returns the text presented on the window at the given baseline, read from the left
+        //   margin until the first empty cell. Each character is read as one byte given by
+        //   "glyphs()".
+        //
+        // [Args]
+        //   baseline (const int32_t): [IN] Vertical position of the baseline.
+        //
+        // [Returns]
+        //   (std::string): Presented text.
+
+        static std::string
+        glyphs(const std::string_view text) noexcept;
+        // [Abstract]
+        //   Returns the given UTF-8 text as it is read by "text()". An ASCII character is read as
+        //   is, and the other characters are read as 0x80 plus the lower 7 bits of the code
+        //   point, so that e.g. "é" and "è" are distinct. A stray continuation byte is not drawn.
+        //
+        // [Args]
+        //   text (const std::string_view): [IN] UTF-8 text.
+        //
+        // [Returns]
+        //   (std::string): Text as presented.
+
+        bool
+        wait_text(const std::vector<std::pair<int32_t, std::string>>& expected, const int64_t timeout_usec) noexcept;
+        // [Abstract]
+        //   Wait until the window presents the given texts at the given baselines.
+        //   This function can be called from any thread.
+        //
+        // [Args]
+        //   expected     (const std::vector<std::pair<int32_t, std::string>>&): [IN] Pairs of the baseline and the text.
+        //   timeout_usec (const int64_t)                                     : [IN] Timeout in micro seconds.
+        //
+        // [Returns]
+        //   (bool): False if timed out.
+
+        bool
+        mapped(void) noexcept;
+        // [Abstract]
+        //   Returns true if the window is shown.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<uint16_t> buffer;
+        // Off-screen buffer. Each pixel holds the color index in the upper 8 bits and the
+        // character of the glyph covering the pixel in the lower 8 bits (0 if no glyph).
+
+        std::vector<uint16_t> screen;
+        // Contents of the window, updated by "present()".
+
+        std::mutex mutex;
+        // Mutex of "this->events", "this->screen" and "this->shown".
+
+        std::condition_variable event_cond;
+        // Condition variable notified when an event is queued.
+
+        std::condition_variable frame_cond;
+        // Condition variable notified when the window is updated.
+
+        std::deque<BackendEvent> events;
+        // Queued events.
+
+        bool shown;
+        // True if the window is shown.
+
+        int32_t pipe_fds[2];
+        // Self-pipe which has one byte while an event is queued, so that it can be polled.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        push_event(const BackendEvent& event) noexcept;
+        // [Abstract]
+        //   Queue the given event and wake up the GUI loop.
+        //
+        // [Args]
+        //   event (const BackendEvent&): [IN] Event to be queued.
+
+        std::string
+        read_text(const int32_t baseline) const noexcept;
+        // [Abstract]
+        //   Same as "text()" but must be called under "this->mutex".
+        //
+        // [Args]
+        //   baseline (const int32_t): [IN] Vertical position of the baseline.
+        //
+        // [Returns]
+        //   (std::string): Presented text.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
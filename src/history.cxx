@@ -0,0 +1,256 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: history.cxx                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "history.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <string_view>
+#include <unordered_map>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// File name of the launch history.
+#define HISTORY_FILENAME ("history.bin")
+
+// The history file is compacted to HISTORY_KEEP_RECORDS records
+// if the number of records exceeds HISTORY_MAX_RECORDS.
+#define HISTORY_MAX_RECORDS  (4096)
+#define HISTORY_KEEP_RECORDS (2048)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The history file is a plain array of the following fixed size records.
+typedef struct
+{
+    int64_t time;      // Launch time (UNIX time).
+    char    name[56];  // Command name padded by NUL.
+}
+HistoryRecord;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::string
+get_history_path(void) noexcept
+// [Abstract]
+//   Returns the path to the history file.
+//
+// [Returns]
+//   (std::string): "$XDG_DATA_HOME/hiruge/history.bin" or "~/.local/share/hiruge/history.bin".
+//
+{   // {{{
+
+    const char* xdg_data = std::getenv("XDG_DATA_HOME");
+    const char* home     = std::getenv("HOME");
+
+    std::filesystem::path root;
+    if      ((xdg_data != nullptr) and (xdg_data[0] != '\0')) root = std::filesystem::path(xdg_data);
+    else if (home != nullptr)                                 root = std::filesystem::path(home) / ".local" / "share";
+    else                                                      return std::string();
+
+    return (root / "hiruge" / HISTORY_FILENAME).string();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+History::History(void) : filepath(get_history_path()), loaded_size(-1)
+{   // {{{
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const std::vector<HistoryEntry>&
+History::entries(void) noexcept
+{   // {{{
+
+    // Reload the history if the size of the history file is changed.
+    struct stat st;
+    const int64_t size = (stat(this->filepath.c_str(), &st) == 0) ? st.st_size : 0;
+
+    if (size != this->loaded_size)
+        this->load(size);
+
+    return this->items;
+
+}   // }}}
+
+void
+History::record(const std::string& name) noexcept
+{   // {{{
+
+    HistoryRecord record;
+
+    // Skip the names that does not fit in a record.
+    if (this->filepath.empty() or name.empty() or (name.size() >= sizeof(record.name)))
+        return;
+
+    std::memset(&record, 0, sizeof(record));
+    record.time = std::time(nullptr);
+    std::memcpy(record.name, name.c_str(), name.size());
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(this->filepath).parent_path(), ec);
+
+    // One write of a small record to a file opened with O_APPEND is not interleaved with
+    // the writes of the other processes.
+    const int fd = open(this->filepath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    const bool written = (write(fd, &record, sizeof(record)) == sizeof(record));
+    const bool large   = written and (fstat(fd, &st) == 0) and (st.st_size > static_cast<off_t>(HISTORY_MAX_RECORDS * sizeof(HistoryRecord)));
+    close(fd);
+
+    if (large)
+        this->compact();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+History::load(const int64_t size) noexcept
+{   // {{{
+
+    this->items.clear();
+    this->loaded_size = size;
+
+    const size_t n_records = size / sizeof(HistoryRecord);
+    if (n_records == 0)
+        return;
+
+    const int fd = open(this->filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    void* addr = mmap(nullptr, n_records * sizeof(HistoryRecord), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        return;
+
+    const HistoryRecord* records = static_cast<const HistoryRecord*>(addr);
+    const int64_t        now     = std::time(nullptr);
+
+    // Aggregate the records by the command name.
+    std::unordered_map<std::string_view, size_t> index;
+
+    for (size_t idx = 0; idx < n_records; ++idx)
+    {
+        const std::string_view name(records[idx].name, strnlen(records[idx].name, sizeof(records[idx].name)));
+        if (name.empty())
+            continue;
+
+        auto iter = index.find(name);
+        if (iter == index.end())
+        {
+            iter = index.emplace(name, this->items.size()).first;
+            this->items.push_back({std::string(name), 0, 0, 0.0});
+        }
+
+        HistoryEntry& entry = this->items[iter->second];
+        entry.count += 1;
+        entry.last   = std::max(entry.last, records[idx].time);
+        entry.score += frecency_weight(now - records[idx].time);
+    }
+
+    munmap(addr, n_records * sizeof(HistoryRecord));
+
+    std::sort(this->items.begin(), this->items.end(), [](const HistoryEntry& a, const HistoryEntry& b) { return a.score > b.score; });
+
+}   // }}}
+
+void
+History::compact(void) noexcept
+{   // {{{
+
+    const int fd = open(this->filepath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    // Only one process compacts the history. Records appended by the other processes between
+    // reading and renaming are lost, which is acceptable for the launch history.
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        close(fd);
+        return;
+    }
+
+    struct stat st;
+    std::vector<HistoryRecord> records;
+
+    if (fstat(fd, &st) == 0)
+    {
+        records.resize(st.st_size / sizeof(HistoryRecord));
+        if (pread(fd, records.data(), records.size() * sizeof(HistoryRecord), 0) != static_cast<ssize_t>(records.size() * sizeof(HistoryRecord)))
+            records.clear();
+    }
+
+    if (records.size() > HISTORY_KEEP_RECORDS)
+    {
+        const std::string tmppath = this->filepath + "." + std::to_string(getpid());
+        const int tmp = open(tmppath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        if (tmp >= 0)
+        {
+            const size_t  bytes   = HISTORY_KEEP_RECORDS * sizeof(HistoryRecord);
+            const ssize_t written = write(tmp, records.data() + records.size() - HISTORY_KEEP_RECORDS, bytes);
+            close(tmp);
+
+            if ((written != static_cast<ssize_t>(bytes)) or (rename(tmppath.c_str(), this->filepath.c_str()) != 0))
+                unlink(tmppath.c_str());
+        }
+    }
+
+    flock(fd, LOCK_UN);
+    close(fd);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+frecency_weight(const int64_t age) noexcept
+{   // {{{
+
+    const int64_t day = 24 * 60 * 60;
+
+    if      (age <  4 * day) return 100.0;
+    else if (age < 14 * day) return  70.0;
+    else if (age < 31 * day) return  50.0;
+    else if (age < 90 * day) return  30.0;
+    else                     return  10.0;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
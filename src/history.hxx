@@ -0,0 +1,116 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: history.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "History" class that manages the launch history and the frecency      ///
+/// (frequency and recency) score of the launched commands.                                      ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HISTORY_HXX
+#define HISTORY_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    std::string name;   // Command name.
+    uint32_t    count;  // Number of launches in the history.
+    int64_t     last;   // Time of the last launch (UNIX time).
+    double      score;  // Frecency score.
+} HistoryEntry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class History
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        History(void);
+        // [Abstract]
+        //   Construct the history. The history file is not accessed until it is needed.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const std::vector<HistoryEntry>&
+        entries(void) noexcept;
+        // [Abstract]
+        //   Returns the launched commands in the descending order of the frecency score.
+        //   The history file is memory-mapped and aggregated at the first call, and reloaded
+        //   if the file is updated by another process.
+        //
+        // [Returns]
+        //   (const std::vector<HistoryEntry>&): Launched commands.
+
+        void
+        record(const std::string& name) noexcept;
+        // [Abstract]
+        //   Append a launch record of the given command to the history file. The record is
+        //   written by one append operation, therefore it is safe for concurrent processes.
+        //
+        // [Args]
+        //   name (const std::string&): [IN] Launched command name.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::string filepath;
+        // Path to the history file.
+
+        std::vector<HistoryEntry> items;
+        // Aggregated launch history.
+
+        int64_t loaded_size;
+        // Size of the history file when it was loaded, or -1 if not loaded yet.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        load(const int64_t size) noexcept;
+        // [Abstract]
+        //   Map the history file and aggregate the records into "this->items".
+        //
+        // [Args]
+        //   size (const int64_t): [IN] Size of the history file.
+
+        void
+        compact(void) noexcept;
+        // [Abstract]
+        //   Drop the old records if the history file becomes too large.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+double
+frecency_weight(const int64_t age) noexcept;
+// [Abstract]
+//   Returns the weight of a launch record of the given age.
+//
+// [Args]
+//   age (const int64_t): [IN] Elapsed time since the launch in seconds.
+//
+// [Returns]
+//   (double): Weight of the record.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -3,18 +3,32 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Include standard libraries.
+#include <csignal>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
 
-// Include X11 headers.
-#include <X11/Xlib.h>
-#include <X11/Xft/Xft.h>
-#include <X11/Xutil.h>
-#include <X11/Xatom.h>
+// Include POSIX headers.
+#include <unistd.h>
 
 // Include custom headers.
+#include "arguments.hxx"
+#include "batch.hxx"
 #include "complete.hxx"
 #include "config.hxx"
+#include "daemon.hxx"
+#include "desktop.hxx"
+#include "files.hxx"
+#include "provider.hxx"
+#include "reader.hxx"
+#include "stats.hxx"
+#include "trace.hxx"
 #include "window.hxx"
+#include "windows.hxx"
+#include "x11.hxx"
+#include "xcb.hxx"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Main function
@@ -24,17 +38,118 @@ int32_t
 main(int32_t argc, char *argv[])
 {   // {{{
 
+    // Parse command line arguments.
+    bool daemon = false;
+    bool picker = false;
+    bool query  = false;
+    for (int32_t idx = 1; idx < argc; ++idx)
+    {
+        if      (std::strcmp(argv[idx], "--daemon")        == 0) daemon = true;
+        else if (std::strcmp(argv[idx], "--stdin")         == 0) picker = true;
+        else if (std::strcmp(argv[idx], "--query")         == 0) query  = true;
+        else if (std::strcmp(argv[idx], "--startup-trace") == 0) enable_startup_trace();
+    }
+
+    // The picker mode selects one of the lines of the standard input, and cannot be resident.
+    // The batch query mode completes each line of the standard input without any window.
+    if (picker or query)
+        daemon = false;
+
+    // Just ask the resident process to show the window if exists.
+    if ((not daemon) and (not picker) and (not query) and notify_daemon())
+        return EXIT_SUCCESS;
+
+    // The launched processes are never waited, therefore let the kernel reap them. This is done
+    // here rather than in "spawn_command()" because the disposition is shared by the process.
+    signal(SIGCHLD, SIG_IGN);
+
     // Load config file.
     load_config("auto");
+    trace_startup("config");
+
+    // Collect the latency statistics if enabled. The resident process dumps them on SIGUSR1,
+    // which must be blocked before any thread is created.
+    int32_t sfd = -1;
+    if (config.latency_stats)
+    {
+        enable_latency_stats(config.latency_file);
+        if (daemon) sfd = open_stats_signal();
+    }
+
+    // Initialize command complete module. The command names are loaded by the worker thread of
+    // the window in parallel with the window creation, and the key inputs are queued until then.
+    Complete complete(picker);
+
+    // Add the providers enabled by the config. The desktop files and the directories are read in
+    // background. The window provider must be created before the main window because it
+    // initializes Xlib for the threads.
+    if ((not picker) and (provider_rank("args", config) >= 0))
+        complete.add_provider("args", std::make_unique<ArgumentProvider>(config));
+
+    if ((not picker) and (provider_rank("files", config) >= 0))
+        complete.add_provider("files", std::make_unique<FileProvider>(config));
+
+    if ((not picker) and (provider_rank("desktop", config) >= 0))
+        complete.add_provider("desktop", std::make_unique<DesktopProvider>(config));
 
-    // Initialize command complete module.
-    Complete complete;
+    if ((not picker) and (not query) and (provider_rank("windows", config) >= 0))
+        complete.add_provider("windows", std::make_unique<WindowProvider>(config));
+
+    // Write the candidates of each query as JSON lines. The windows are not listed because
+    // no X server may be available for the batch query. All providers are waited for each query
+    // so that the same input always gives the same output.
+    if (query)
+    {
+        config.provider_deadline = -1;
+        complete.load();
+        std::ios::sync_with_stdio(false);
+        run_queries(complete, std::cin, std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    // Watch the directories before loading so that no change is missed.
+    const int32_t wfd = daemon ? complete.watch() : -1;
 
     // Start window.
-    MainWindow window;
-    window.start(argc, argv, complete);
+    std::unique_ptr<Backend> backend;
+    if (config.window_backend == "xcb") backend = std::make_unique<XcbBackend>();
+    else                                backend = std::make_unique<X11Backend>();
+
+    MainWindow window(complete, *backend);
+    trace_startup("window");
+
+    if (daemon)
+    {
+        const int32_t fd = open_daemon_socket();
+        if (fd < 0)
+        {
+            std::cout << "\033[33mHiRuGe: Failed to open the socket (another daemon is running?)\033[m" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        // Show the window when a client requests.
+        window.add_watch(fd, [fd, &window](void) { if (accept_daemon_request(fd)) window.show(); });
+
+        // Dump the latency statistics when SIGUSR1 is received.
+        if (sfd >= 0)
+            window.add_watch(sfd, [sfd](void) { accept_stats_signal(sfd); });
+
+        // Keep the command names up to date while the process is resident.
+        if (wfd >= 0)
+            window.add_watch(wfd, [&window, &complete](void) { window.refresh([&complete](void) { return complete.on_watch_event(); }); });
+    }
+
+    // Read the candidates from the standard input in the picker mode. The window is shown
+    // immediately and the candidates are added while the user is typing.
+    std::unique_ptr<LineReader> reader;
+    if (picker)
+        reader = std::make_unique<LineReader>(STDIN_FILENO, [&window](std::vector<std::string>&& sorted) { window.append(std::move(sorted)); });
+
+    const bool executed = window.start(argc, argv, daemon);
+    dump_latency_stats();
 
-    return EXIT_SUCCESS;
+    // Like dmenu, the picker mode fails if canceled.
+    return (picker and (not executed)) ? EXIT_FAILURE : EXIT_SUCCESS;
 
 }   // }}}
 
@@ -0,0 +1,244 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: pool.cxx                                                                    ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "pool.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum number of threads including the calling thread.
+#define POOL_MAX_THREADS (64)
+
+// Distance between the ranges of the threads in "ThreadPool::ranges" (one cache line).
+#define POOL_STRIDE (64 / sizeof(uint64_t))
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t
+make_range(const uint64_t first, const uint64_t last) noexcept
+// [Abstract]
+//   Pack the given range of tasks into a 64-bit integer.
+//
+// [Args]
+//   first (const uint64_t): [IN] First task.
+//   last  (const uint64_t): [IN] Last task plus one.
+//
+// [Returns]
+//   (uint64_t): Packed range.
+//
+{   // {{{
+
+    return (last << 32) | first;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadPool::ThreadPool(const size_t n_threads) : job(nullptr), epoch(0), pending(0), quit(false), stopped(false)
+{   // {{{
+
+    // Use all cores by default.
+    const size_t total = std::min<size_t>((n_threads > 0) ? n_threads : std::max(std::thread::hardware_concurrency(), 1u), POOL_MAX_THREADS);
+
+    this->ranges.reset(new std::atomic<uint64_t>[total * POOL_STRIDE]);
+    for (size_t idx = 0; idx < total; ++idx)
+        this->ranges[idx * POOL_STRIDE].store(0);
+
+    // The pool works with fewer threads if a thread cannot be created.
+    for (size_t idx = 1; idx < total; ++idx)
+    {
+        try                     { this->threads.emplace_back(&ThreadPool::loop, this, idx); }
+        catch (std::exception&) { break;                                                     }
+    }
+
+}   // }}}
+
+ThreadPool::~ThreadPool(void)
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->quit = true;
+    }
+
+    this->start_cond.notify_all();
+
+    for (std::thread& thread : this->threads)
+        thread.join();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+ThreadPool::run(const size_t n_tasks, const PoolTask& task) noexcept
+{   // {{{
+
+    // Run a single task on the calling thread without waking up the others.
+    if (n_tasks <= 1)
+        return (n_tasks == 0) or task(0, 0);
+
+    // Split the tasks evenly. The threads without tasks start by stealing.
+    const size_t n_threads = this->size();
+
+    for (size_t idx = 0; idx < n_threads; ++idx)
+    {
+        const size_t first = std::min(n_tasks, n_tasks * idx / n_threads);
+        const size_t last  = std::min(n_tasks, n_tasks * (idx + 1) / n_threads);
+        this->ranges[idx * POOL_STRIDE].store(make_range(first, last));
+    }
+
+    this->stopped.store(false);
+
+    if (not this->threads.empty())
+    {
+        {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            this->job     = &task;
+            this->pending = this->threads.size();
+            this->epoch  += 1;
+        }
+
+        this->start_cond.notify_all();
+    }
+
+    this->work(0, task);
+
+    // Wait for the other threads, because the task may refer to the local variables of the caller.
+    {
+        std::unique_lock<std::mutex> guard(this->mutex);
+        this->done_cond.wait(guard, [this](void) { return this->pending == 0; });
+        this->job = nullptr;
+    }
+
+    return not this->stopped.load();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+ThreadPool::loop(const size_t thread) noexcept
+{   // {{{
+
+    uint64_t seen = 0;
+
+    while (true)
+    {
+        const PoolTask* task;
+
+        {
+            std::unique_lock<std::mutex> guard(this->mutex);
+            this->start_cond.wait(guard, [this, seen](void) { return this->quit or (this->epoch != seen); });
+
+            if (this->quit)
+                return;
+
+            seen = this->epoch;
+            task = this->job;
+        }
+
+        this->work(thread, *task);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> guard(this->mutex);
+            last = (--this->pending == 0);
+        }
+
+        if (last)
+            this->done_cond.notify_one();
+    }
+
+}   // }}}
+
+void
+ThreadPool::work(const size_t thread, const PoolTask& task) noexcept
+{   // {{{
+
+    size_t index;
+
+    while ((not this->stopped.load(std::memory_order_relaxed)) and (this->take(thread, index) or this->steal(thread, index)))
+        if (not task(index, thread))
+            this->stopped.store(true);
+
+}   // }}}
+
+bool
+ThreadPool::take(const size_t thread, size_t& target) noexcept
+{   // {{{
+
+    std::atomic<uint64_t>& range = this->ranges[thread * POOL_STRIDE];
+    uint64_t               value = range.load();
+
+    // Retry if a thief shrinks the range meanwhile.
+    while (true)
+    {
+        const uint64_t first = value & 0xFFFFFFFF;
+        const uint64_t last  = value >> 32;
+
+        if (first >= last)
+            return false;
+
+        if (range.compare_exchange_weak(value, make_range(first + 1, last)))
+        {
+            target = first;
+            return true;
+        }
+    }
+
+}   // }}}
+
+bool
+ThreadPool::steal(const size_t thread, size_t& target) noexcept
+{   // {{{
+
+    const size_t n_threads = this->size();
+
+    // Visit the other threads starting from the next one, so that the thieves are spread.
+    for (size_t offset = 1; offset < n_threads; ++offset)
+    {
+        std::atomic<uint64_t>& range = this->ranges[((thread + offset) % n_threads) * POOL_STRIDE];
+        uint64_t               value = range.load();
+
+        while (true)
+        {
+            const uint64_t first = value & 0xFFFFFFFF;
+            const uint64_t last  = value >> 32;
+
+            if (first >= last)
+                break;
+
+            // Steal [middle, last). A single remaining task is also stolen.
+            const uint64_t middle = first + (last - first) / 2;
+
+            if (range.compare_exchange_weak(value, make_range(first, middle)))
+            {
+                // No other thread modifies the own range while it is empty, because a thief
+                // never updates an empty range.
+                this->ranges[thread * POOL_STRIDE].store(make_range(middle + 1, last));
+                target = middle;
+                return true;
+            }
+        }
+    }
+
+    return false;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: pool.hxx                                                                    ///
+///                                                                                              ///
+/// This file provides the "ThreadPool" class, a persistent pool of threads that runs a batch of ///
+/// indexed tasks with work stealing. Each thread owns a contiguous range of the tasks and takes ///
+/// them from the front, and an idle thread steals the back half of the range of another thread. ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef POOL_HXX
+#define POOL_HXX
+
+// Include the headers of STL.
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Function called with the task index and the thread index. Returns false to cancel the batch.
+typedef std::function<bool(size_t, size_t)> PoolTask;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ThreadPool
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        explicit ThreadPool(const size_t n_threads = 0);
+        ~ThreadPool(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        size_t
+        size(void) const noexcept { return this->threads.size() + 1; }
+        // [Abstract]
+        //   Returns the number of the threads including the calling thread of "run()".
+        //   The thread index given to the task is less than this value.
+
+        bool
+        run(const size_t n_tasks, const PoolTask& task) noexcept;
+        // [Abstract]
+        //   Run the tasks of the index in [0, n_tasks) and wait for them. The calling thread also
+        //   runs the tasks as the thread index 0, and no other thread is woken up if there is only
+        //   one task. When a task returns false, no more task is started and the running tasks
+        //   are waited for. This function must not be called concurrently.
+        //
+        // [Args]
+        //   n_tasks (const size_t)   : [IN] Number of tasks.
+        //   task    (const PoolTask&): [IN] Task to be called with the task and thread indices.
+        //
+        // [Returns]
+        //   (bool): False if cancelled by a task.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::thread> threads;
+        // Threads except for the calling thread of "run()".
+
+        std::unique_ptr<std::atomic<uint64_t>[]> ranges;
+        // Range of the remaining tasks of each thread. The lower 32 bits are the first task and
+        // the upper 32 bits are the last task plus one, so that both are updated atomically.
+        // The elements are padded to separate cache lines.
+
+        std::mutex mutex;
+        // Mutex of "this->job", "this->epoch", "this->pending" and "this->quit".
+
+        std::condition_variable start_cond;
+        // Condition variable notified when a batch starts or the pool is destructed.
+
+        std::condition_variable done_cond;
+        // Condition variable notified when all threads finish the batch.
+
+        const PoolTask* job;
+        // Task of the current batch.
+
+        uint64_t epoch;
+        // Serial number of the current batch.
+
+        size_t pending;
+        // Number of the threads working on the current batch.
+
+        bool quit;
+        // True if the threads should exit.
+
+        std::atomic<bool> stopped;
+        // True if the current batch is cancelled.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        loop(const size_t thread) noexcept;
+        // [Abstract]
+        //   Main loop of the pool threads that waits for the batches.
+        //
+        // [Args]
+        //   thread (const size_t): [IN] Thread index.
+
+        void
+        work(const size_t thread, const PoolTask& task) noexcept;
+        // [Abstract]
+        //   Run the tasks of the own range, and then the stolen ones until no task remains.
+        //
+        // [Args]
+        //   thread (const size_t)   : [IN] Thread index.
+        //   task   (const PoolTask&): [IN] Task of the current batch.
+
+        bool
+        take(const size_t thread, size_t& target) noexcept;
+        // [Abstract]
+        //   Take the first task of the own range.
+        //
+        // [Args]
+        //   thread (const size_t): [IN]  Thread index.
+        //   target (size_t&)     : [OUT] Task index.
+        //
+        // [Returns]
+        //   (bool): False if the own range is empty.
+
+        bool
+        steal(const size_t thread, size_t& target) noexcept;
+        // [Abstract]
+        //   Steal the back half of the range of another thread. The first stolen task is returned
+        //   and the others become the own range. Must be called only if the own range is empty.
+        //
+        // [Args]
+        //   thread (const size_t): [IN]  Thread index.
+        //   target (size_t&)     : [OUT] Task index.
+        //
+        // [Returns]
+        //   (bool): False if no task remains in any thread.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
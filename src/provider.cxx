@@ -0,0 +1,281 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: provider.cxx                                                                ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "provider.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Include custom headers.
+#include "config.hxx"
+#include "fuzzy.hxx"
+#include "spawn.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Interval of polling the cancellation while waiting for the providers [usec].
+#define PROVIDER_POLL_INTERVAL (1000)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static char
+to_lower(const char c) noexcept
+// [Abstract]
+//   Returns the lower case of the given ASCII character.
+//
+// [Args]
+//   c (const char): [IN] Input character.
+//
+// [Returns]
+//   (char): Lower case character.
+//
+{   // {{{
+
+    return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions of Provider
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+Provider::launch(const ProviderItem& item) noexcept
+{   // {{{
+
+    return spawn_command(item.action);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors of ProviderSet
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ProviderSet::ProviderSet(void) : generation(0), expired(0), stop(false), latest(0)
+{   // {{{
+
+}   // }}}
+
+ProviderSet::~ProviderSet(void)
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+        this->stop = true;
+        this->latest.store(++this->generation);
+    }
+
+    this->request_cond.notify_all();
+
+    for (const std::unique_ptr<Slot>& slot : this->slots)
+        slot->thread.join();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions of ProviderSet
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+ProviderSet::add(std::unique_ptr<Provider>&& provider, const int32_t rank) noexcept
+{   // {{{
+
+    this->slots.push_back(std::make_unique<Slot>(Slot{std::move(provider), rank, std::thread(), 0, std::string(), {}}));
+
+    Slot& slot = *this->slots.back();
+    slot.thread = std::thread(&ProviderSet::run, this, std::ref(slot));
+
+}   // }}}
+
+void
+ProviderSet::set_callback(const std::function<void(void)>& callback) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+    this->callback = callback;
+
+}   // }}}
+
+void
+ProviderSet::request(const std::string& input) noexcept
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->mutex);
+
+        // The same input is not queried again, e.g. when the candidates are updated for the
+        // late result or the added command names.
+        if ((this->generation != 0) and (input == this->input))
+            return;
+
+        this->input = input;
+        this->latest.store(++this->generation);
+    }
+
+    this->request_cond.notify_all();
+
+}   // }}}
+
+bool
+ProviderSet::wait(const int64_t timeout_usec, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(timeout_usec);
+
+    std::unique_lock<std::mutex> guard(this->mutex);
+
+    auto completed = [this](void)
+    {
+        return std::all_of(this->slots.begin(), this->slots.end(), [this](const std::unique_ptr<Slot>& slot) { return slot->done == this->generation; });
+    };
+
+    while (not completed())
+    {
+        // The slow providers are not waited twice for the same request. Their results are
+        // notified by the callback instead.
+        if (this->expired == this->generation)
+            return true;
+
+        if (cancelled and cancelled())
+            return false;
+
+        const auto now = std::chrono::steady_clock::now();
+        if ((timeout_usec >= 0) and (now >= deadline))
+        {
+            this->expired = this->generation;
+            return true;
+        }
+
+        // The cancellation is polled because it is not notified by the condition variable.
+        if (timeout_usec >= 0) this->done_cond.wait_for(guard, std::min<std::chrono::steady_clock::duration>(deadline - now, std::chrono::microseconds(PROVIDER_POLL_INTERVAL)));
+        else                   this->done_cond.wait_for(guard, std::chrono::microseconds(PROVIDER_POLL_INTERVAL));
+    }
+
+    return true;
+
+}   // }}}
+
+void
+ProviderSet::items(const size_t slot, const std::string& input, std::vector<ProviderItem>& target) noexcept
+{   // {{{
+
+    std::lock_guard<std::mutex> guard(this->mutex);
+
+    const Slot& source = *this->slots[slot];
+
+    if ((source.done != 0) and (source.input == input)) target = source.result;
+    else                                                target.clear();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions of ProviderSet
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+ProviderSet::run(Slot& slot) noexcept
+{   // {{{
+
+    uint64_t seen = 0;
+
+    while (true)
+    {
+        std::string input;
+        uint64_t    generation;
+
+        // Wait for a request which is not queried yet by this provider.
+        {
+            std::unique_lock<std::mutex> guard(this->mutex);
+            this->request_cond.wait(guard, [this, seen](void) { return this->stop or (this->generation != seen); });
+
+            if (this->stop)
+                return;
+
+            input = this->input;
+            seen  = generation = this->generation;
+        }
+
+        // The query is abandoned if a newer request arrives.
+        std::vector<ProviderItem> items;
+        slot.provider->query(input, items, [this, generation](void) { return this->latest.load(std::memory_order_relaxed) != generation; });
+
+        if (items.size() > PROVIDER_MAX_ITEMS)
+            items.resize(PROVIDER_MAX_ITEMS);
+
+        {
+            std::lock_guard<std::mutex> guard(this->mutex);
+
+            // The results of the older requests are discarded because they may be partial.
+            if (this->generation != generation)
+                continue;
+
+            slot.result = std::move(items);
+            slot.input  = input;
+            slot.done   = generation;
+
+            // Ask the owner to merge the result again if the deadline is already expired.
+            if ((this->expired == generation) and this->callback)
+                this->callback();
+        }
+
+        this->done_cond.notify_all();
+    }
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+provider_rank(const std::string& name, const Config& settings) noexcept
+{   // {{{
+
+    const auto iter = std::find(settings.providers.begin(), settings.providers.end(), name);
+    return (iter != settings.providers.end()) ? static_cast<int32_t>(iter - settings.providers.begin()) : -1;
+
+}   // }}}
+
+bool
+match_label(const std::string& input, const std::string& input_lower, const std::string_view label, int32_t& score, const Config& settings) noexcept
+{   // {{{
+
+    score = 0;
+
+    // The prefix mode is case sensitive as well as the command names.
+    if (settings.match_mode == "prefix")
+        return label.compare(0, input.size(), input) == 0;
+
+    // The other modes compare the lower case label. The padding is required by "fuzzy_match()".
+    std::string lower(label);
+    std::transform(lower.begin(), lower.end(), lower.begin(), to_lower);
+    lower.append(FUZZY_PADDING, '\0');
+
+    if (settings.match_mode == "substring")
+    {
+        const void* hit = memmem(lower.data(), label.size(), input_lower.data(), input_lower.size());
+        if (hit == nullptr)
+            return false;
+
+        score = -static_cast<int32_t>(static_cast<const char*>(hit) - lower.data());
+        return true;
+    }
+
+    size_t end = 0;
+    if (not fuzzy_match(lower.data(), input_lower, end))
+        return false;
+
+    score = fuzzy_score(label.data(), lower.data(), end, input, input_lower);
+    return true;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,270 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: provider.hxx                                                                ///
+///                                                                                              ///
+/// This file provides the "Provider" class, the interface of the candidate sources other than   ///
+/// the command names in "PATH" and the aliases, and the "ProviderSet" class which queries the   ///
+/// providers in parallel on their own threads. The providers are enabled and ordered by the     ///
+/// "providers" config value.                                                                    ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef PROVIDER_HXX
+#define PROVIDER_HXX
+
+// Include the headers of STL.
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Include custom headers.
+#include "config.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum number of the items returned by a provider for one query.
+#define PROVIDER_MAX_ITEMS (8)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    std::string label;   // Text shown as the candidate.
+    std::string action;  // Value given to "Provider::launch()" (a command line by default).
+    int32_t     score;   // Matching score computed by "match_label()" (larger is better).
+} ProviderItem;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Provider
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        virtual ~Provider(void) {}
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        virtual void
+        query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept = 0;
+        // [Abstract]
+        //   Find at most PROVIDER_MAX_ITEMS items that match to the given user input, in the
+        //   descending order of the score. This function is called on the thread of the provider,
+        //   and should return early if the given function returns true.
+        //
+        // [Args]
+        //   input     (const std::string&)              : [IN]  User input (not empty).
+        //   items     (std::vector<ProviderItem>&)      : [OUT] Matched items (empty when called).
+        //   cancelled (const std::function<bool(void)>&): [IN]  Returns true if the result is no longer needed.
+
+        virtual int32_t
+        launch(const ProviderItem& item) noexcept;
+        // [Abstract]
+        //   Launch the given item selected by the user. The default implementation launches the
+        //   action as a command line. This function is called on the GUI thread.
+        //
+        // [Args]
+        //   item (const ProviderItem&): [IN] Selected item.
+        //
+        // [Returns]
+        //   (int32_t): Zero if launched, otherwise the error number.
+};
+
+class ProviderSet
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         ProviderSet(void);
+        ~ProviderSet(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        size_t
+        size(void) const noexcept { return this->slots.size(); }
+        // [Abstract]
+        //   Returns the number of the providers.
+
+        int32_t
+        rank(const size_t slot) const noexcept { return this->slots[slot]->rank; }
+        // [Abstract]
+        //   Returns the position of the provider in the "providers" config value.
+
+        Provider&
+        provider(const size_t slot) noexcept { return *this->slots[slot]->provider; }
+        // [Abstract]
+        //   Returns the provider of the given slot.
+
+        void
+        add(std::unique_ptr<Provider>&& provider, const int32_t rank) noexcept;
+        // [Abstract]
+        //   Add a provider and start its thread. This function must be called before "request()".
+        //
+        // [Args]
+        //   provider (std::unique_ptr<Provider>&&): [IN] Provider.
+        //   rank     (const int32_t)              : [IN] Position in the "providers" config value.
+
+        void
+        set_callback(const std::function<void(void)>& callback) noexcept;
+        // [Abstract]
+        //   Set the function called on the provider thread when a provider returns the result
+        //   after "wait()" gave up on it. The result can be taken by calling "wait()" and
+        //   "items()" again with the same input.
+        //
+        // [Args]
+        //   callback (const std::function<void(void)>&): [IN] Function called for a late result.
+
+        void
+        request(const std::string& input) noexcept;
+        // [Abstract]
+        //   Ask all providers to query the given user input. The queries in progress are
+        //   cancelled. Nothing happens if the input is the same as the latest request.
+        //
+        // [Args]
+        //   input (const std::string&): [IN] User input.
+
+        bool
+        wait(const int64_t timeout_usec, const std::function<bool(void)>& cancelled) noexcept;
+        // [Abstract]
+        //   Wait until all providers return the results of the latest request or the timeout
+        //   expires. The timeout applies only once for each request, and the later calls for
+        //   the same request return immediately. A negative timeout waits for all providers.
+        //
+        // [Args]
+        //   timeout_usec (const int64_t)                     : [IN] Timeout in micro seconds, or negative for no timeout.
+        //   cancelled    (const std::function<bool(void)>&): [IN] Polled while waiting.
+        //
+        // [Returns]
+        //   (bool): False if cancelled.
+
+        void
+        items(const size_t slot, const std::string& input, std::vector<ProviderItem>& target) noexcept;
+        // [Abstract]
+        //   Copy the latest result of the given provider if it is the result of the given input.
+        //   Otherwise, the target is cleared.
+        //
+        // [Args]
+        //   slot   (const size_t)              : [IN]  Index of the provider.
+        //   input  (const std::string&)        : [IN]  User input.
+        //   target (std::vector<ProviderItem>&): [OUT] Items of the provider.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private data types
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        typedef struct {
+            std::unique_ptr<Provider> provider;  // Provider.
+            int32_t                   rank;      // Position in the "providers" config value.
+            std::thread               thread;    // Thread running the queries.
+            uint64_t                  done;      // Generation of the latest result.
+            std::string               input;     // User input of the latest result.
+            std::vector<ProviderItem> result;    // Latest result.
+        } Slot;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<std::unique_ptr<Slot>> slots;
+        // Providers and their results.
+
+        std::mutex mutex;
+        // Mutex of the all member variables except for "this->slots" itself and "this->latest".
+
+        std::condition_variable request_cond;
+        // Condition variable notified when a new request arrives or the threads should exit.
+
+        std::condition_variable done_cond;
+        // Condition variable notified when a provider returns the result.
+
+        std::string input;
+        // User input of the latest request.
+
+        uint64_t generation;
+        // Generation number of the latest request (zero if no request yet).
+
+        uint64_t expired;
+        // Generation number of the latest request whose deadline is expired.
+
+        bool stop;
+        // True if the threads should exit.
+
+        std::atomic<uint64_t> latest;
+        // Copy of "this->generation" that can be read without the lock.
+
+        std::function<void(void)> callback;
+        // Function called for a late result.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        run(Slot& slot) noexcept;
+        // [Abstract]
+        //   Main loop of the provider thread.
+        //
+        // [Args]
+        //   slot (Slot&): [IN/OUT] Provider and its result.
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+provider_rank(const std::string& name, const Config& settings) noexcept;
+// [Abstract]
+//   Returns the position of the given provider in the "providers" config value.
+//
+// [Args]
+//   name     (const std::string&): [IN] Provider name.
+//   settings (const Config&)     : [IN] Config values.
+//
+// [Returns]
+//   (int32_t): Position of the provider, or -1 if not enabled.
+
+bool
+match_label(const std::string& input, const std::string& input_lower, const std::string_view label, int32_t& score,
+            const Config& settings) noexcept;
+// [Abstract]
+//   Returns true if the given label matches to the user input in the matching mode of the
+//   config, and computes the score in the same scale as the command names. The score is zero in
+//   the prefix mode, the fuzzy score in the fuzzy mode, and the negated position in the
+//   substring mode.
+//
+// [Args]
+//   input       (const std::string&)    : [IN]  User input (not empty).
+//   input_lower (const std::string&)    : [IN]  Lower case user input.
+//   label       (const std::string_view): [IN]  Label of the item.
+//   score       (int32_t&)              : [OUT] Matching score.
+//   settings    (const Config&)         : [IN]  Config values.
+//
+// [Returns]
+//   (bool): True if matched.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: reader.cxx                                                                  ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "reader.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+// Include POSIX headers.
+#include <poll.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum length of a line in bytes. The rest of a longer line is discarded.
+#define READER_MAX_LINE (4096)
+
+// Minimum number of lines in a batch.
+#define READER_BATCH_MIN (4096)
+
+// A batch is passed if this time has passed since the last batch, even if it is small.
+#define READER_FLUSH_MSEC (50)
+
+// Size of the read buffer.
+#define READER_BUFFER_SIZE (65536)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+LineReader::LineReader(const int32_t fd, std::function<void(std::vector<std::string>&&)> callback)
+    : fd(fd), callback(std::move(callback)), stop(false)
+{   // {{{
+
+    this->thread = std::thread(&LineReader::run, this);
+
+}   // }}}
+
+LineReader::~LineReader(void)
+{   // {{{
+
+    this->stop.store(true);
+    this->thread.join();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+LineReader::run(void) noexcept
+{   // {{{
+
+    std::vector<char>        buffer(READER_BUFFER_SIZE);
+    std::vector<std::string> batch;
+    std::string              line;
+    size_t                   total = 0;
+    bool                     eof   = false;
+    bool                     skip  = false;
+
+    auto last_flush = std::chrono::steady_clock::now();
+
+    // Add the current line to the batch.
+    auto finish_line = [&line, &batch, &skip](void)
+    {
+        skip = false;
+
+        if ((not line.empty()) and (line.back() == '\r'))
+            line.pop_back();
+
+        if (not line.empty())
+            batch.push_back(std::move(line));
+
+        line.clear();
+    };
+
+    // Pass the batch to the callback.
+    auto flush = [this, &batch, &total, &last_flush](void)
+    {
+        last_flush = std::chrono::steady_clock::now();
+
+        if (batch.empty())
+            return;
+
+        std::sort(batch.begin(), batch.end());
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+        total += batch.size();
+        this->callback(std::move(batch));
+        batch.clear();
+    };
+
+    while ((not eof) and (not this->stop.load()))
+    {
+        // Wait with a timeout so that the stop flag and the flush timer are checked.
+        struct pollfd pfd = {this->fd, POLLIN, 0};
+        const int32_t ready = poll(&pfd, 1, READER_FLUSH_MSEC);
+
+        if (ready > 0)
+        {
+            const ssize_t size = read(this->fd, buffer.data(), buffer.size());
+
+            if ((size == 0) or ((size < 0) and (errno != EINTR) and (errno != EAGAIN)))
+                eof = true;
+
+            for (ssize_t pos = 0; pos < size;)
+            {
+                // Find the end of the line in the buffer.
+                const char*   head = buffer.data() + pos;
+                const char*   tail = static_cast<const char*>(std::memchr(head, '\n', size - pos));
+                const ssize_t len  = (tail != nullptr) ? (tail - head) : (size - pos);
+
+                // Append the part of the line within the length limit and skip the rest. A NUL
+                // byte also ends the line, because the names are stored as NUL terminated strings.
+                size_t      take = skip ? 0 : std::min<size_t>(READER_MAX_LINE - line.size(), len);
+                const char* nul  = static_cast<const char*>(std::memchr(head, '\0', take));
+
+                if (nul != nullptr)
+                {
+                    take = nul - head;
+                    skip = true;
+                }
+
+                line.append(head, take);
+                skip |= (line.size() >= READER_MAX_LINE);
+
+                pos += len;
+
+                if (tail != nullptr)
+                {
+                    finish_line();
+                    pos += 1;
+                }
+            }
+        }
+        else if ((ready < 0) and (errno != EINTR))
+            eof = true;
+
+        // Pass the batch if large enough or late.
+        const size_t limit = std::max<size_t>(READER_BATCH_MIN, total / 2);
+        const auto   now   = std::chrono::steady_clock::now();
+
+        if ((batch.size() >= limit) or (now - last_flush >= std::chrono::milliseconds(READER_FLUSH_MSEC)))
+            flush();
+    }
+
+    // Pass the rest if all lines are read.
+    if (eof)
+    {
+        finish_line();
+        flush();
+    }
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: reader.hxx                                                                  ///
+///                                                                                              ///
+/// This file provides the "LineReader" class that reads lines from a file descriptor (e.g. the  ///
+/// standard input) on a background thread and passes them in sorted batches.                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef READER_HXX
+#define READER_HXX
+
+// Include the headers of STL.
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class LineReader
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        LineReader(const int32_t fd, std::function<void(std::vector<std::string>&&)> callback);
+        ~LineReader(void);
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        int32_t fd;
+        // File descriptor to be read.
+
+        std::function<void(std::vector<std::string>&&)> callback;
+        // Function called on the reader thread with each batch of lines, which is sorted in
+        // the dictionary order without duplication.
+
+        std::atomic<bool> stop;
+        // True if the reader thread should exit.
+
+        std::thread thread;
+        // Reader thread.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        run(void) noexcept;
+        // [Abstract]
+        //   Main loop of the reader thread. A batch is passed when it is large enough or some time
+        //   has passed since the last batch. The batch size grows with the number of lines read
+        //   so far, therefore the total cost of merging the batches stays linear. Lines longer
+        //   than READER_MAX_LINE bytes are truncated, and empty lines are skipped.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
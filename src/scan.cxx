@@ -0,0 +1,362 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: scan.cxx                                                                    ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "scan.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+
+// Include POSIX headers.
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum number of threads used for scanning.
+#define SCAN_MAX_THREADS (8)
+
+// Number of directory entries checked by one task.
+#define SCAN_CHUNK_SIZE (1024)
+
+// Size of the buffer passed to getdents64.
+#define SCAN_BUFFER_SIZE (32768)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    size_t dir;
+    size_t first;
+    size_t last;
+}
+ScanChunk;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void
+parallel_for(const size_t n_tasks, const std::function<void(size_t)>& task) noexcept
+// [Abstract]
+//   Run the given task for each index in [0, n_tasks) on a small pool of threads.
+//   The calling thread also runs the tasks, so all tasks are done even if no thread is created.
+//
+// [Args]
+//   n_tasks (const size_t)                      : [IN] Number of tasks.
+//   task    (const std::function<void(size_t)>&): [IN] Task to be called with the task index.
+//
+{   // {{{
+
+    std::atomic<size_t> next(0);
+
+    auto run = [&next, &task, n_tasks](void)
+    {
+        for (size_t idx = next.fetch_add(1); idx < n_tasks; idx = next.fetch_add(1))
+            task(idx);
+    };
+
+    const size_t n_threads = std::min<size_t>({std::max(std::thread::hardware_concurrency(), 1u), SCAN_MAX_THREADS, n_tasks});
+
+    std::vector<std::thread> threads;
+    for (size_t idx = 1; idx < n_threads; ++idx)
+    {
+        try                    { threads.emplace_back(run); }
+        catch (std::exception&) { break;                      }
+    }
+
+    run();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+}   // }}}
+
+template <typename Item, typename Key>
+static void
+merge_runs(std::vector<std::vector<Item>>& runs, std::vector<Item>& target, const Key& key) noexcept
+// [Abstract]
+//   Merge the given sorted lists into one sorted list without duplication by a k-way merge.
+//   The items are moved from the given lists.
+//
+// [Args]
+//   runs   (std::vector<std::vector<Item>>&): [IN]  Lists sorted by the key.
+//   target (std::vector<Item>&)             : [OUT] Merged items.
+//   key    (const Key&)                     : [IN]  Function which returns the sort key of an item.
+//
+{   // {{{
+
+    size_t total = 0;
+    for (const std::vector<Item>& run : runs)
+        total += run.size();
+
+    target.clear();
+    target.reserve(total);
+
+    // Min-heap of the run indices ordered by the current head of each run.
+    std::vector<size_t> heads(runs.size(), 0);
+    std::vector<size_t> heap;
+
+    auto is_greater = [&runs, &heads, &key](const size_t a, const size_t b) { return key(runs[a][heads[a]]) > key(runs[b][heads[b]]); };
+
+    for (size_t idx = 0; idx < runs.size(); ++idx)
+        if (not runs[idx].empty())
+            heap.push_back(idx);
+
+    std::make_heap(heap.begin(), heap.end(), is_greater);
+
+    while (not heap.empty())
+    {
+        std::pop_heap(heap.begin(), heap.end(), is_greater);
+        const size_t run = heap.back();
+
+        // Skip the duplicated items.
+        Item& item = runs[run][heads[run]];
+        if (target.empty() or (key(target.back()) != key(item)))
+            target.push_back(std::move(item));
+
+        if (++heads[run] < runs[run].size()) std::push_heap(heap.begin(), heap.end(), is_greater);
+        else                                 heap.pop_back();
+    }
+
+}   // }}}
+
+static int32_t
+read_directory(const std::string& path, std::vector<std::string>& entries) noexcept
+// [Abstract]
+//   Open the given directory and read the entries that may be a command.
+//
+// [Args]
+//   path    (const std::string&)       : [IN]  Directory path.
+//   entries (std::vector<std::string>&): [OUT] Regular files, symbolic links and unknown type entries.
+//
+// [Returns]
+//   (int32_t): File descriptor of the opened directory, or -1 if failed.
+//
+{   // {{{
+
+    const int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return -1;
+
+    alignas(struct dirent64) char buffer[SCAN_BUFFER_SIZE];
+    ssize_t size;
+
+    while ((size = getdents64(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (ssize_t pos = 0; pos < size; pos += reinterpret_cast<struct dirent64*>(buffer + pos)->d_reclen)
+        {
+            const struct dirent64* entry = reinterpret_cast<struct dirent64*>(buffer + pos);
+
+            // Skip the entries which cannot be a command without calling stat.
+            if ((entry->d_type != DT_REG) and (entry->d_type != DT_LNK) and (entry->d_type != DT_UNKNOWN))
+                continue;
+
+            if ((std::strcmp(entry->d_name, ".") == 0) or (std::strcmp(entry->d_name, "..") == 0))
+                continue;
+
+            entries.emplace_back(entry->d_name);
+        }
+    }
+
+    return fd;
+
+}   // }}}
+
+static FileStamp
+read_stamp(const int32_t dirfd, const char* name) noexcept
+// [Abstract]
+//   Returns the status of the given file following the symbolic links. Exactly one stat call is
+//   made for each file, because the execute bit needs the mode of the target anyway.
+//
+// [Args]
+//   dirfd (const int32_t): [IN] File descriptor of the directory.
+//   name  (const char*)  : [IN] File name.
+//
+// [Returns]
+//   (FileStamp): Status of the file. The mode is 0 if the file is not accessible.
+//
+{   // {{{
+
+    struct stat st;
+
+    // Dangling links fail here.
+    if (fstatat(dirfd, name, &st, 0) != 0)
+        return {0, 0, 0, 0, 0};
+
+    return {static_cast<uint32_t>(st.st_mode), 0, static_cast<uint64_t>(st.st_ino), st.st_ctim.tv_sec, st.st_ctim.tv_nsec};
+
+}   // }}}
+
+static bool
+same_stamp(const FileStamp& a, const FileStamp& b) noexcept
+// [Abstract]
+//   Returns true if the given status are the same.
+//
+// [Args]
+//   a (const FileStamp&): [IN] Status of a file.
+//   b (const FileStamp&): [IN] Status of a file.
+//
+// [Returns]
+//   (bool): True if the same.
+//
+{   // {{{
+
+    return (a.mode == b.mode) and (a.ino == b.ino) and (a.ctime_sec == b.ctime_sec) and (a.ctime_nsec == b.ctime_nsec);
+
+}   // }}}
+
+static void
+split_chunks(const std::vector<size_t>& sizes, std::vector<ScanChunk>& chunks) noexcept
+// [Abstract]
+//   Split the entries of each directory into chunks so that a large directory is checked by
+//   multiple threads. The chunks of the same directory are contiguous.
+//
+// [Args]
+//   sizes  (const std::vector<size_t>&): [IN]  Number of entries of each directory.
+//   chunks (std::vector<ScanChunk>&)   : [OUT] Chunks.
+//
+{   // {{{
+
+    for (size_t dir = 0; dir < sizes.size(); ++dir)
+        for (size_t first = 0; first < sizes[dir]; first += SCAN_CHUNK_SIZE)
+            chunks.push_back({dir, first, std::min(first + SCAN_CHUNK_SIZE, sizes[dir])});
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+scan_directories(const std::vector<std::string>& paths, std::vector<std::vector<ScanEntry>>& target) noexcept
+{   // {{{
+
+    const size_t n_dirs = paths.size();
+
+    // Read the entries of each directory in parallel. Reading the entries is cheap compared to
+    // the stat calls, so one task per directory is enough.
+    std::vector<std::vector<std::string>> entries(n_dirs);
+    std::vector<int32_t>                  dirfds(n_dirs, -1);
+
+    parallel_for(n_dirs, [&](size_t idx) { dirfds[idx] = read_directory(paths[idx], entries[idx]); });
+
+    std::vector<size_t> sizes;
+    for (const std::vector<std::string>& names : entries)
+        sizes.push_back(names.size());
+
+    std::vector<ScanChunk> chunks;
+    split_chunks(sizes, chunks);
+
+    // Read the status and sort the entries of each chunk.
+    std::vector<std::vector<ScanEntry>> runs(chunks.size());
+
+    parallel_for(chunks.size(), [&](size_t idx)
+    {
+        const ScanChunk& chunk = chunks[idx];
+
+        runs[idx].reserve(chunk.last - chunk.first);
+        for (size_t pos = chunk.first; pos < chunk.last; ++pos)
+        {
+            const FileStamp stamp = read_stamp(dirfds[chunk.dir], entries[chunk.dir][pos].c_str());
+            runs[idx].push_back({std::move(entries[chunk.dir][pos]), stamp});
+        }
+
+        std::sort(runs[idx].begin(), runs[idx].end(), [](const ScanEntry& a, const ScanEntry& b) { return a.name < b.name; });
+    });
+
+    for (const int32_t fd : dirfds)
+        if (fd >= 0)
+            close(fd);
+
+    // Merge the sorted chunks of each directory. The chunks of the same directory are contiguous.
+    target.assign(n_dirs, {});
+
+    for (size_t first = 0, last = 0; first < chunks.size(); first = last)
+    {
+        while ((last < chunks.size()) and (chunks[last].dir == chunks[first].dir))
+            ++last;
+
+        std::vector<std::vector<ScanEntry>> dir_runs(std::make_move_iterator(runs.begin() + first), std::make_move_iterator(runs.begin() + last));
+        merge_runs(dir_runs, target[chunks[first].dir], [](const ScanEntry& entry) -> const std::string& { return entry.name; });
+    }
+
+}   // }}}
+
+void
+check_directories(const std::vector<std::string>& paths, const std::vector<std::vector<ScannedEntry>>& entries,
+                  std::vector<bool>& fresh) noexcept
+{   // {{{
+
+    const size_t n_dirs = paths.size();
+
+    // The flags are written by multiple threads when a directory is split into chunks.
+    std::unique_ptr<std::atomic<bool>[]> flags(new std::atomic<bool>[n_dirs]);
+    std::vector<int32_t>                 dirfds(n_dirs, -1);
+
+    parallel_for(n_dirs, [&](size_t idx)
+    {
+        dirfds[idx] = open(paths[idx].c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        flags[idx].store(dirfds[idx] >= 0, std::memory_order_relaxed);
+    });
+
+    std::vector<size_t> sizes;
+    for (const std::vector<ScannedEntry>& files : entries)
+        sizes.push_back(files.size());
+
+    std::vector<ScanChunk> chunks;
+    split_chunks(sizes, chunks);
+
+    // Stop checking a directory at the first changed file, because it is rescanned anyway.
+    parallel_for(chunks.size(), [&](size_t idx)
+    {
+        const ScanChunk& chunk = chunks[idx];
+
+        for (size_t pos = chunk.first; (pos < chunk.last) and flags[chunk.dir].load(std::memory_order_relaxed); ++pos)
+        {
+            const ScannedEntry& entry = entries[chunk.dir][pos];
+            if (not same_stamp(read_stamp(dirfds[chunk.dir], entry.name.data()), entry.stamp))
+                flags[chunk.dir].store(false, std::memory_order_relaxed);
+        }
+    });
+
+    for (const int32_t fd : dirfds)
+        if (fd >= 0)
+            close(fd);
+
+    fresh.assign(n_dirs, false);
+    for (size_t idx = 0; idx < n_dirs; ++idx)
+        fresh[idx] = flags[idx].load(std::memory_order_relaxed);
+
+}   // }}}
+
+bool
+is_executable(const FileStamp& stamp) noexcept
+{   // {{{
+
+    return S_ISREG(stamp.mode) and ((stamp.mode & (S_IXUSR | S_IXGRP | S_IXOTH)) != 0);
+
+}   // }}}
+
+void
+merge_names(std::vector<std::vector<std::string>>& runs, std::vector<std::string>& target) noexcept
+{   // {{{
+
+    merge_runs(runs, target, [](const std::string& name) -> const std::string& { return name; });
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
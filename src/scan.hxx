@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: scan.hxx                                                                    ///
+///                                                                                              ///
+/// This file provides the functions to list the files in the directories of "PATH" with their   ///
+/// status using a small pool of threads, to check that the status is unchanged later, and to    ///
+/// merge the sorted lists of command names.                                                     ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCAN_HXX
+#define SCAN_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Status of a file following the symbolic links. A change of the execute bit or of the target
+// of a link does not modify the directory, but changes one of these values.
+typedef struct
+{
+    uint32_t mode;        // File mode, or 0 if the file is not accessible (e.g. dangling link).
+    uint32_t reserved;    // Always 0.
+    uint64_t ino;         // Inode number.
+    int64_t  ctime_sec;   // Status change time (seconds).
+    int64_t  ctime_nsec;  // Status change time (nanoseconds).
+}
+FileStamp;
+
+typedef struct
+{
+    std::string name;   // File name.
+    FileStamp   stamp;  // Status of the file.
+}
+ScanEntry;
+
+typedef struct
+{
+    std::string_view name;   // File name (NUL terminated).
+    FileStamp        stamp;  // Status of the file when scanned.
+}
+ScannedEntry;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+scan_directories(const std::vector<std::string>& paths, std::vector<std::vector<ScanEntry>>& target) noexcept;
+// [Abstract]
+//   Get the regular files and the symbolic links in each of the given directories with their
+//   status as lists sorted by the name. The directories are scanned in parallel, and a large
+//   directory is split into chunks which are checked in parallel.
+//
+// [Args]
+//   paths  (const std::vector<std::string>&)     : [IN]  Directory paths.
+//   target (std::vector<std::vector<ScanEntry>>&): [OUT] Sorted files of each directory.
+
+void
+check_directories(const std::vector<std::string>& paths, const std::vector<std::vector<ScannedEntry>>& entries,
+                  std::vector<bool>& fresh) noexcept;
+// [Abstract]
+//   Check that the status of all files scanned before is unchanged, in parallel in the same
+//   way as "scan_directories()". The added and removed files are not detected because they
+//   modify the directory.
+//
+// [Args]
+//   paths   (const std::vector<std::string>&)               : [IN]  Directory paths.
+//   entries (const std::vector<std::vector<ScannedEntry>>&): [IN]  Files scanned before in each directory.
+//   fresh   (std::vector<bool>&)                            : [OUT] True if no file of the directory is changed.
+
+bool
+is_executable(const FileStamp& stamp) noexcept;
+// [Abstract]
+//   Returns true if the given status is of an executable regular file.
+//
+// [Args]
+//   stamp (const FileStamp&): [IN] Status of a file.
+//
+// [Returns]
+//   (bool): True if the file is a command.
+
+void
+merge_names(std::vector<std::vector<std::string>>& runs, std::vector<std::string>& target) noexcept;
+// [Abstract]
+//   Merge the given sorted lists into one sorted list without duplication by a k-way merge.
+//   The strings are moved from the given lists.
+//
+// [Args]
+//   runs   (std::vector<std::vector<std::string>>&): [IN]  Sorted lists of names.
+//   target (std::vector<std::string>&)             : [OUT] Merged names.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: spawn.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "spawn.hxx"
+
+// Include the headers of STL.
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <vector>
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Characters that require a shell to interpret the command line.
+#define SHELL_CHARACTERS ("|&;<>()$`\\\"'*?[]#~{}")
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static bool
+needs_shell(const std::string& command) noexcept
+// [Abstract]
+//   Returns true if the given command line contains shell syntax.
+//
+// [Args]
+//   command (const std::string&): [IN] Command line.
+//
+// [Returns]
+//   (bool): True if the command line should be executed by a shell.
+//
+{   // {{{
+
+    if (command.find_first_of(SHELL_CHARACTERS) != std::string::npos)
+        return true;
+
+    // Variable assignment before the command (e.g. "LANG=C xterm").
+    const size_t first_space = command.find_first_of(" \t");
+    return command.substr(0, first_space).find('=') != std::string::npos;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+spawn_command(const std::string& command) noexcept
+{   // {{{
+
+    // Build the argument list.
+    std::vector<std::string> words;
+    if (needs_shell(command)) words = {"/bin/sh", "-c", command};
+    else                      split_words(command, words);
+
+    if (words.empty())
+        return ENOENT;
+
+    std::vector<char*> argv;
+    for (std::string& word : words)
+        argv.push_back(word.data());
+    argv.push_back(nullptr);
+
+    // Connect the standard input/output to /dev/null.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO,  "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+    // Detach from the session of the launcher, and reset the signal settings. The disposition of
+    // SIGCHLD is restored to the default in case the launcher ignores it to reap the processes.
+    sigset_t sigdefault;
+    sigset_t sigmask;
+    sigemptyset(&sigdefault);
+    sigaddset(&sigdefault, SIGCHLD);
+    sigaddset(&sigdefault, SIGPIPE);
+    sigemptyset(&sigmask);
+
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSID | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK);
+    posix_spawnattr_setsigdefault(&attr, &sigdefault);
+    posix_spawnattr_setsigmask(&attr, &sigmask);
+
+    // The failure of exec (e.g. command not found) is also reported as the return value.
+    pid_t pid;
+    const int32_t error = posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    return error;
+
+}   // }}}
+
+size_t
+split_words(const std::string_view command, std::vector<std::string>& words) noexcept
+{   // {{{
+
+    words.clear();
+
+    size_t last   = command.size();
+    bool   inside = false;
+    char   quote  = '\0';
+
+    for (size_t pos = 0; pos < command.size(); ++pos)
+    {
+        const char c = command[pos];
+
+        // The unquoted white spaces end the current word.
+        if ((quote == '\0') and ((c == ' ') or (c == '\t') or (c == '\n')))
+        {
+            inside = false;
+            continue;
+        }
+
+        if (not inside)
+        {
+            words.emplace_back();
+            last   = pos;
+            inside = true;
+        }
+
+        std::string& word = words.back();
+
+        if (quote == '\'')
+        {
+            if (c == '\'') quote = '\0';
+            else           word.push_back(c);
+        }
+        else if (c == '\\')
+        {
+            // A trailing backslash is ignored, and a backslash and a newline are removed (line
+            // continuation). In double quotes, a backslash before the other characters is literal.
+            if (pos + 1 >= command.size())
+                continue;
+
+            const char next = command[pos + 1];
+
+            if      ((quote == '"') and (std::strchr("$`\"\\\n", next) == nullptr)) word.push_back(c);
+            else if (next == '\n'                                                  ) ++pos;
+            else                                                                     word.push_back(command[++pos]);
+        }
+        else if (quote == '"')
+        {
+            if (c == '"') quote = '\0';
+            else          word.push_back(c);
+        }
+        else if ((c == '\'') or (c == '"')) quote = c;
+        else                                word.push_back(c);
+    }
+
+    return inside ? last : command.size();
+
+}   // }}}
+
+std::string
+quote_word(const std::string_view word) noexcept
+{   // {{{
+
+    if (word.empty())
+        return "''";
+
+    std::string quoted;
+    quoted.reserve(word.size());
+
+    for (const char c : word)
+    {
+        if (c == '\n')
+        {
+            quoted.append("'\n'");
+            continue;
+        }
+
+        if ((c == ' ') or (c == '\t') or (std::strchr(SHELL_CHARACTERS, c) != nullptr))
+            quoted.push_back('\\');
+
+        quoted.push_back(c);
+    }
+
+    return quoted;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
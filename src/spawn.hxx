@@ -0,0 +1,69 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: spawn.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the function `spawn_command` which launches a command line as a detached  ///
+/// process without going through a shell where possible, and the functions to split and quote   ///
+/// the words of a command line in the same way as the shell.                                    ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef SPAWN_HXX
+#define SPAWN_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int32_t
+spawn_command(const std::string& command) noexcept;
+// [Abstract]
+//   Launch the given command line in a new session with the standard input/output connected
+//   to /dev/null. The command line is split by white spaces and executed directly, unless it
+//   contains shell syntax (quotes, pipes, redirections, variables, globs, etc.) in which case
+//   it is executed by "/bin/sh -c". The launched process is never waited, therefore the caller
+//   should reap it (e.g. HiRuGe ignores SIGCHLD in "main()").
+//
+// [Args]
+//   command (const std::string&): [IN] Command line to be launched.
+//
+// [Returns]
+//   (int32_t): Zero if launched, otherwise the error number (e.g. ENOENT).
+
+size_t
+split_words(const std::string_view command, std::vector<std::string>& words) noexcept;
+// [Abstract]
+//   Split the given command line into words by the quoting rules of the shell, and remove the
+//   quotes. The unquoted white spaces separate the words, a backslash quotes the next character,
+//   and the single and double quotes quote the characters up to the closing one (a backslash in
+//   double quotes quotes only "$", "`", double quote, backslash and newline). An unclosed quote
+//   continues to the end. No expansion is performed.
+//
+// [Args]
+//   command (const std::string_view)   : [IN]  Command line.
+//   words   (std::vector<std::string>&): [OUT] Words without quotes.
+//
+// [Returns]
+//   (size_t): Position where the last word starts, or the size of the command line if it ends
+//             with a white space (i.e. a new word is being typed).
+
+std::string
+quote_word(const std::string_view word) noexcept;
+// [Abstract]
+//   Returns the given word quoted so that "split_words()" and the shell read it as one literal
+//   word. The white spaces and the characters of the shell syntax are escaped by a backslash,
+//   and a newline is put in single quotes because a backslash and a newline are removed.
+//
+// [Args]
+//   word (const std::string_view): [IN] Literal word.
+//
+// [Returns]
+//   (std::string): Quoted word.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
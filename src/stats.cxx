@@ -0,0 +1,271 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: stats.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "stats.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+// Include POSIX headers.
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Default file name of the output file.
+#define STATS_FILENAME ("latency.jsonl")
+
+// Each power of two is divided into 2^STATS_SUB_BITS buckets, therefore the relative error of
+// the bucket bounds is at most 1 / 2^STATS_SUB_BITS (12.5%).
+#define STATS_SUB_BITS  (3)
+#define STATS_SUB_COUNT (1 << STATS_SUB_BITS)
+
+// Number of buckets that covers all 64-bit values.
+#define STATS_N_BUCKETS ((64 - STATS_SUB_BITS + 1) * STATS_SUB_COUNT)
+
+// Names of the stages of the index STATS_*.
+static const char* const STAGE_NAMES[] = {"key_to_echo", "key_to_frame", "update", "redraw", "flush"};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    std::atomic<uint64_t> counts[STATS_N_BUCKETS];  // Number of the samples in each bucket.
+    std::atomic<uint64_t> total;                    // Sum of the samples [nsec].
+    std::atomic<uint64_t> max;                      // Maximum of the samples [nsec].
+}
+Histogram;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static variables
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// True if the latency statistics are enabled. Written only before the threads are created.
+static bool stats_enabled = false;
+
+// Path to the output file.
+static std::string stats_filepath;
+
+// Histograms of each stage.
+static Histogram stats_histograms[STATS_N_STAGES];
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline size_t
+bucket_index(const uint64_t value) noexcept
+// [Abstract]
+//   Returns the index of the bucket which contains the given value. The values less than
+//   STATS_SUB_COUNT have their own buckets, and the others are bucketed by the position of the
+//   highest bit and the following STATS_SUB_BITS bits.
+//
+// [Args]
+//   value (const uint64_t): [IN] Sample value.
+//
+// [Returns]
+//   (size_t): Bucket index.
+//
+{   // {{{
+
+    if (value < STATS_SUB_COUNT)
+        return value;
+
+    const size_t exponent = 63 - __builtin_clzll(value);
+    const size_t mantissa = (value >> (exponent - STATS_SUB_BITS)) & (STATS_SUB_COUNT - 1);
+
+    return (exponent - STATS_SUB_BITS + 1) * STATS_SUB_COUNT + mantissa;
+
+}   // }}}
+
+static inline uint64_t
+bucket_upper(const size_t index) noexcept
+// [Abstract]
+//   Returns the largest value of the given bucket.
+//
+// [Args]
+//   index (const size_t): [IN] Bucket index.
+//
+// [Returns]
+//   (uint64_t): Largest value of the bucket.
+//
+{   // {{{
+
+    if (index < STATS_SUB_COUNT)
+        return index;
+
+    const size_t   exponent = index / STATS_SUB_COUNT + STATS_SUB_BITS - 1;
+    const uint64_t lower    = static_cast<uint64_t>(STATS_SUB_COUNT + index % STATS_SUB_COUNT) << (exponent - STATS_SUB_BITS);
+
+    return lower + (static_cast<uint64_t>(1) << (exponent - STATS_SUB_BITS)) - 1;
+
+}   // }}}
+
+static std::string
+get_stats_path(void) noexcept
+// [Abstract]
+//   Returns the default path to the output file.
+//
+// [Returns]
+//   (std::string): "$XDG_CACHE_HOME/hiruge/latency.jsonl" or "~/.cache/hiruge/latency.jsonl".
+//
+{   // {{{
+
+    const char* xdg_cache = std::getenv("XDG_CACHE_HOME");
+    const char* home      = std::getenv("HOME");
+
+    std::filesystem::path root;
+    if      ((xdg_cache != nullptr) and (xdg_cache[0] != '\0')) root = std::filesystem::path(xdg_cache);
+    else if (home != nullptr)                                   root = std::filesystem::path(home) / ".cache";
+    else                                                        return std::string();
+
+    return (root / "hiruge" / STATS_FILENAME).string();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+enable_latency_stats(const std::string& filepath) noexcept
+{   // {{{
+
+    stats_filepath = (filepath == "auto") ? get_stats_path() : filepath;
+    stats_enabled  = not stats_filepath.empty();
+
+}   // }}}
+
+uint64_t
+stats_clock(void) noexcept
+{   // {{{
+
+    if (not stats_enabled)
+        return 0;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+}   // }}}
+
+void
+stats_record(const int32_t stage, const uint64_t start) noexcept
+{   // {{{
+
+    if (start == 0)
+        return;
+
+    const uint64_t value     = stats_clock() - start;
+    Histogram&     histogram = stats_histograms[stage];
+
+    histogram.counts[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    histogram.total.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = histogram.max.load(std::memory_order_relaxed);
+    while ((value > max) and (not histogram.max.compare_exchange_weak(max, value, std::memory_order_relaxed)));
+
+}   // }}}
+
+bool
+dump_latency_stats(void) noexcept
+{   // {{{
+
+    if (not stats_enabled)
+        return true;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(stats_filepath).parent_path(), ec);
+
+    std::ofstream file(stats_filepath, std::ios::app);
+    if (not file)
+        return false;
+
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+
+    file << "{\"time\":" << std::chrono::duration_cast<std::chrono::seconds>(now).count() << ",\"pid\":" << getpid();
+
+    for (size_t stage = 0; stage < STATS_N_STAGES; ++stage)
+    {
+        const Histogram& histogram = stats_histograms[stage];
+
+        // Take a snapshot of the counts. The samples recorded meanwhile may be partially included.
+        uint64_t counts[STATS_N_BUCKETS], n_samples = 0;
+        for (size_t idx = 0; idx < STATS_N_BUCKETS; ++idx)
+            n_samples += (counts[idx] = histogram.counts[idx].load(std::memory_order_relaxed));
+
+        // The percentiles are the upper bounds of the buckets, but not more than the maximum [usec].
+        const uint64_t max      = histogram.max.load();
+        const double   ratios[] = {0.50, 0.90, 0.99};
+        double         values[] = {0.0,  0.0,  0.0 };
+
+        for (size_t pos = 0, idx = 0, seen = 0; (pos < 3) and (idx < STATS_N_BUCKETS); ++idx)
+            for (seen += counts[idx]; (pos < 3) and (seen > 0) and (seen >= ratios[pos] * n_samples); ++pos)
+                values[pos] = std::min(bucket_upper(idx), max) / 1000.0;
+
+        file << ",\"" << STAGE_NAMES[stage] << "\":{\"count\":" << n_samples
+             << ",\"mean_us\":" << ((n_samples > 0) ? histogram.total.load() / 1000.0 / n_samples : 0.0)
+             << ",\"p50_us\":"  << values[0]
+             << ",\"p90_us\":"  << values[1]
+             << ",\"p99_us\":"  << values[2]
+             << ",\"max_us\":"  << max / 1000.0
+             << ",\"buckets\":[";
+
+        // Non-empty buckets as the pairs of the upper bound [usec] and the count.
+        bool first = true;
+        for (size_t idx = 0; idx < STATS_N_BUCKETS; ++idx)
+        {
+            if (counts[idx] == 0)
+                continue;
+
+            file << (first ? "" : ",") << "[" << bucket_upper(idx) / 1000.0 << "," << counts[idx] << "]";
+            first = false;
+        }
+
+        file << "]}";
+    }
+
+    file << "}" << std::endl;
+
+    return static_cast<bool>(file);
+
+}   // }}}
+
+int32_t
+open_stats_signal(void) noexcept
+{   // {{{
+
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGUSR1);
+
+    // The signal is delivered through the file descriptor instead of a handler.
+    if (pthread_sigmask(SIG_BLOCK, &mask, nullptr) != 0)
+        return -1;
+
+    return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+
+}   // }}}
+
+void
+accept_stats_signal(const int32_t fd) noexcept
+{   // {{{
+
+    struct signalfd_siginfo info;
+    while (read(fd, &info, sizeof(info)) == sizeof(info));
+
+    dump_latency_stats();
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
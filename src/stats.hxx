@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: stats.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the functions to collect the latency of the hot path from the key events  ///
+/// to the window contents into histograms, which is enabled by "latency_stats" config value.    ///
+/// The histograms are appended to a file as a JSON line on exit or when SIGUSR1 is received.    ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef STATS_HXX
+#define STATS_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Measured stages.
+#define STATS_KEY_TO_ECHO  (0)  // Key event to the redraw of the input line.
+#define STATS_KEY_TO_FRAME (1)  // Key event to the redraw of the candidate line of the input.
+#define STATS_UPDATE       (2)  // "Complete::update()" on the worker thread.
+#define STATS_REDRAW       (3)  // Rendering and presenting the window contents.
+#define STATS_FLUSH        (4)  // Flushing the requests to the window system.
+#define STATS_N_STAGES     (5)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+enable_latency_stats(const std::string& filepath) noexcept;
+// [Abstract]
+//   Enable the latency statistics. This function should be called before any thread is created.
+//
+// [Args]
+//   filepath (const std::string&): [IN] Path to the output file, or "auto" for
+//                                       "$XDG_CACHE_HOME/hiruge/latency.jsonl".
+
+uint64_t
+stats_clock(void) noexcept;
+// [Abstract]
+//   Returns the current time to be given to "stats_record()". This function just returns zero
+//   if the latency statistics are disabled.
+//
+// [Returns]
+//   (uint64_t): Current time [nsec], or zero if disabled.
+
+void
+stats_record(const int32_t stage, const uint64_t start) noexcept;
+// [Abstract]
+//   Add the elapsed time from the given start time to the histogram of the given stage.
+//   Nothing happens if the start time is zero. This function is thread safe and lock free.
+//
+// [Args]
+//   stage (const int32_t) : [IN] One of STATS_*.
+//   start (const uint64_t): [IN] Start time returned by "stats_clock()".
+
+bool
+dump_latency_stats(void) noexcept;
+// [Abstract]
+//   Append the histograms to the output file as a JSON line. The counts are cumulative from
+//   the start of the process. Nothing happens if the latency statistics are disabled.
+//
+// [Returns]
+//   (bool): False if failed to write the file.
+
+int32_t
+open_stats_signal(void) noexcept;
+// [Abstract]
+//   Block SIGUSR1 and returns a file descriptor which becomes readable when it is received.
+//   This function should be called before any thread is created so that all threads block it.
+//
+// [Returns]
+//   (int32_t): File descriptor, or -1 if failed.
+
+void
+accept_stats_signal(const int32_t fd) noexcept;
+// [Abstract]
+//   Consume the received signals and dump the histograms.
+//
+// [Args]
+//   fd (const int32_t): [IN] File descriptor returned by "open_stats_signal()".
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
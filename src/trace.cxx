@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: trace.cxx                                                                   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "trace.hxx"
+
+// Include the headers of STL.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <set>
+#include <string>
+
+// Include POSIX headers.
+#include <unistd.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static variables
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// True if the startup trace is enabled.
+static std::atomic<bool> trace_enabled(false);
+
+// Time when the startup trace is enabled.
+static std::chrono::steady_clock::time_point trace_origin;
+
+// Phases already printed and its mutex.
+static std::set<std::string> trace_printed;
+static std::mutex            trace_mutex;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+enable_startup_trace(void) noexcept
+{   // {{{
+
+    trace_origin = std::chrono::steady_clock::now();
+    trace_enabled.store(true);
+
+}   // }}}
+
+void
+trace_startup(const char* phase) noexcept
+{   // {{{
+
+    if (not trace_enabled.load())
+        return;
+
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - trace_origin).count();
+
+    std::lock_guard<std::mutex> guard(trace_mutex);
+
+    if (not trace_printed.insert(phase).second)
+        return;
+
+    std::fprintf(stderr, "HiRuGe: startup %-10s %9.3f ms (tid %d)\n", phase, elapsed, static_cast<int>(gettid()));
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
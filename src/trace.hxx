@@ -0,0 +1,33 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: trace.hxx                                                                   ///
+///                                                                                              ///
+/// This file provides the functions to print the elapsed time of each startup phase, which is  ///
+/// enabled by "--startup-trace" option.                                                         ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRACE_HXX
+#define TRACE_HXX
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+enable_startup_trace(void) noexcept;
+// [Abstract]
+//   Enable the startup trace. The elapsed time is measured from the call of this function,
+//   therefore this function should be called at the beginning of the main function.
+
+void
+trace_startup(const char* phase) noexcept;
+// [Abstract]
+//   Print the elapsed time and the thread of the given phase to the standard error if the
+//   startup trace is enabled. Only the first call of each phase is printed, therefore this
+//   function can be placed in a loop. This function is thread safe.
+//
+// [Args]
+//   phase (const char*): [IN] Name of the phase.
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
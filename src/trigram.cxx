@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: trigram.cxx                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "trigram.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Number of trigram keys (3 bytes).
+#define TRIGRAM_N_KEYS (1 << 24)
+
+// Number of postings between the skip pointers.
+#define TRIGRAM_SKIP_INTERVAL (64)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Data type declaration
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Sequential reader of a posting list.
+typedef struct
+{
+    const uint8_t*     head;       // Head of the encoded postings.
+    const uint8_t*     ptr;        // Position of the next posting.
+    const TrigramSkip* skips;      // Skip pointers of the list.
+    uint32_t           n_skips;    // Number of the skip pointers.
+    uint32_t           next_skip;  // Index of the first skip pointer not passed yet.
+    uint32_t           remaining;  // Number of postings not decoded yet.
+    uint32_t           value;      // Last decoded name index.
+}
+TrigramCursor;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t
+make_key(const char* str) noexcept
+// [Abstract]
+//   Returns the trigram at the head of the given string packed into 24 bits.
+//
+// [Args]
+//   str (const char*): [IN] String of 3 or more characters.
+//
+// [Returns]
+//   (uint32_t): Trigram key.
+//
+{   // {{{
+
+    return (static_cast<uint32_t>(static_cast<uint8_t>(str[0])) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(str[1])) << 8) | static_cast<uint8_t>(str[2]);
+
+}   // }}}
+
+static void
+collect_keys(const char* lower, const size_t length, std::vector<uint32_t>& keys) noexcept
+// [Abstract]
+//   Get the distinct trigrams of the given string.
+//
+// [Args]
+//   lower  (const char*)           : [IN]  Lower case string.
+//   length (const size_t)          : [IN]  Length of the string.
+//   keys   (std::vector<uint32_t>&): [OUT] Sorted distinct trigrams.
+//
+{   // {{{
+
+    keys.clear();
+
+    for (size_t pos = 0; pos + 3 <= length; ++pos)
+        keys.push_back(make_key(lower + pos));
+
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+}   // }}}
+
+static uint32_t
+varint_size(uint32_t value) noexcept
+// [Abstract]
+//   Returns the number of bytes of the given value in the LEB128 format.
+//
+// [Args]
+//   value (uint32_t): [IN] Value to be encoded.
+//
+// [Returns]
+//   (uint32_t): Encoded size in bytes.
+//
+{   // {{{
+
+    uint32_t size = 1;
+
+    for (; value >= 0x80; value >>= 7)
+        ++size;
+
+    return size;
+
+}   // }}}
+
+static uint32_t
+put_varint(uint8_t* target, uint32_t value) noexcept
+// [Abstract]
+//   Write the given value in the LEB128 format.
+//
+// [Args]
+//   target (uint8_t*): [OUT] Output buffer which has enough space.
+//   value  (uint32_t): [IN]  Value to be encoded.
+//
+// [Returns]
+//   (uint32_t): Number of the written bytes.
+//
+{   // {{{
+
+    uint32_t size = 0;
+
+    for (; value >= 0x80; value >>= 7)
+        target[size++] = static_cast<uint8_t>(value | 0x80);
+
+    target[size++] = static_cast<uint8_t>(value);
+
+    return size;
+
+}   // }}}
+
+static inline bool
+cursor_next(TrigramCursor& cursor) noexcept
+// [Abstract]
+//   Decode the next posting.
+//
+// [Args]
+//   cursor (TrigramCursor&): [IN/OUT] Cursor of a posting list.
+//
+// [Returns]
+//   (bool): False if no posting remains.
+//
+{   // {{{
+
+    if (cursor.remaining == 0)
+        return false;
+
+    uint32_t delta = 0;
+    for (uint32_t shift = 0; ; shift += 7)
+    {
+        const uint8_t byte = *cursor.ptr++;
+        delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+
+    cursor.value     += delta;
+    cursor.remaining -= 1;
+
+    return true;
+
+}   // }}}
+
+static bool
+cursor_seek(TrigramCursor& cursor, const uint32_t target, const uint32_t count) noexcept
+// [Abstract]
+//   Advance the cursor to the first posting which is equal to or greater than the given value.
+//   The blocks whose last posting is less than the value are skipped without decoding.
+//
+// [Args]
+//   cursor (TrigramCursor&): [IN/OUT] Cursor of a posting list. The current posting must be
+//                                     less than the target, or no posting is decoded yet.
+//   target (const uint32_t): [IN]     Value to be searched.
+//   count  (const uint32_t): [IN]     Number of postings of the list.
+//
+// [Returns]
+//   (bool): False if no such posting exists.
+//
+{   // {{{
+
+    // Jump to the end of the last block which ends before the target.
+    bool jumped = false;
+    while ((cursor.next_skip < cursor.n_skips) and (cursor.skips[cursor.next_skip].value < target))
+    {
+        ++cursor.next_skip;
+        jumped = true;
+    }
+
+    if (jumped)
+    {
+        const TrigramSkip& skip = cursor.skips[cursor.next_skip - 1];
+        const uint32_t     done = cursor.next_skip * TRIGRAM_SKIP_INTERVAL;
+
+        if (done >= count - cursor.remaining)
+        {
+            cursor.ptr       = cursor.head + skip.offset;
+            cursor.value     = skip.value;
+            cursor.remaining = count - done;
+        }
+    }
+
+    // Decode the rest linearly.
+    while (cursor_next(cursor))
+        if (cursor.value >= target)
+            return true;
+
+    return false;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+TrigramIndex::build(const Catalog& catalog) noexcept
+{   // {{{
+
+    this->lists.clear();
+    this->data.clear();
+    this->skips.clear();
+
+    // Dense tables of the trigrams. The tables are allocated by calloc so that only the pages of
+    // the trigrams that actually appear are touched.
+    typedef std::unique_ptr<uint32_t, decltype(&std::free)> Table;
+
+    Table counts(static_cast<uint32_t*>(std::calloc(TRIGRAM_N_KEYS, sizeof(uint32_t))), &std::free);
+    Table sizes(static_cast<uint32_t*>(std::calloc(TRIGRAM_N_KEYS, sizeof(uint32_t))), &std::free);
+    Table lasts(static_cast<uint32_t*>(std::calloc(TRIGRAM_N_KEYS, sizeof(uint32_t))), &std::free);
+
+    if ((counts == nullptr) or (sizes == nullptr) or (lasts == nullptr))
+        return;
+
+    // Count the postings and the encoded bytes of each trigram. The names are visited in the
+    // ascending order of the index, therefore the deltas are always positive, and the trigram
+    // that appears twice in a name is detected by the last index without sorting the trigrams.
+    for (uint32_t index = 0; index < catalog.size(); ++index)
+    {
+        const char*  lower  = catalog.lower(index);
+        const size_t length = catalog.name(index).size();
+
+        for (size_t pos = 0; pos + 3 <= length; ++pos)
+        {
+            const uint32_t key = make_key(lower + pos);
+
+            if ((counts.get()[key] != 0) and (lasts.get()[key] == index))
+                continue;
+
+            sizes.get()[key]  += varint_size(index - lasts.get()[key]);
+            counts.get()[key] += 1;
+            lasts.get()[key]   = index;
+        }
+    }
+
+    // Assign the region of each posting list in the ascending order of the trigram, and replace
+    // the counts with the list indices.
+    size_t n_bytes = 0;
+    size_t n_skips = 0;
+
+    for (uint32_t key = 0; key < TRIGRAM_N_KEYS; ++key)
+    {
+        const uint32_t count = counts.get()[key];
+        if (count == 0)
+            continue;
+
+        this->lists.push_back({key, count, static_cast<uint32_t>(n_bytes), static_cast<uint32_t>(n_skips)});
+        counts.get()[key] = static_cast<uint32_t>(this->lists.size() - 1);
+
+        n_bytes += sizes.get()[key];
+        n_skips += count / TRIGRAM_SKIP_INTERVAL;
+    }
+
+    // The positions are stored as 32-bit integers. Leave the index empty if it is too large.
+    if (n_bytes > UINT32_MAX)
+    {
+        this->lists.clear();
+        return;
+    }
+
+    this->data.resize(n_bytes);
+    this->skips.resize(n_skips);
+
+    // Encode the postings into the assigned regions.
+    std::vector<uint32_t> positions(this->lists.size());
+    std::vector<uint32_t> previous(this->lists.size(), 0);
+    std::vector<uint32_t> written(this->lists.size(), 0);
+
+    for (size_t slot = 0; slot < this->lists.size(); ++slot)
+        positions[slot] = this->lists[slot].data;
+
+    for (uint32_t index = 0; index < catalog.size(); ++index)
+    {
+        const char*  lower  = catalog.lower(index);
+        const size_t length = catalog.name(index).size();
+
+        for (size_t pos = 0; pos + 3 <= length; ++pos)
+        {
+            const uint32_t     slot = counts.get()[make_key(lower + pos)];
+            const TrigramList& list = this->lists[slot];
+
+            if ((written[slot] != 0) and (previous[slot] == index))
+                continue;
+
+            positions[slot] += put_varint(this->data.data() + positions[slot], index - previous[slot]);
+            previous[slot]   = index;
+            written[slot]   += 1;
+
+            if (written[slot] % TRIGRAM_SKIP_INTERVAL == 0)
+                this->skips[list.skip + written[slot] / TRIGRAM_SKIP_INTERVAL - 1] = {index, positions[slot] - list.data};
+        }
+    }
+
+}   // }}}
+
+void
+TrigramIndex::search(const Catalog& catalog, const std::string& query, std::vector<uint32_t>& target) const noexcept
+{   // {{{
+
+    target.clear();
+
+    // No name matches if any trigram is missing.
+    std::vector<const TrigramList*> found;
+    if (not this->lookup(query, found))
+        return;
+
+    // Intersect from the shortest list, so that the longer lists are mostly skipped.
+
+    auto open = [this](const TrigramList* list) -> TrigramCursor
+    {
+        const uint32_t n_skips = ((list + 1 < this->lists.data() + this->lists.size()) ? (list + 1)->skip : this->skips.size()) - list->skip;
+        return {this->data.data() + list->data, this->data.data() + list->data, this->skips.data() + list->skip, n_skips, 0, list->count, 0};
+    };
+
+    TrigramCursor first = open(found[0]);
+    target.reserve(found[0]->count);
+    while (cursor_next(first))
+        target.push_back(first.value);
+
+    for (size_t idx = 1; (idx < found.size()) and (not target.empty()); ++idx)
+    {
+        TrigramCursor cursor = open(found[idx]);
+        size_t        kept   = 0;
+        bool          alive  = true;
+
+        for (size_t pos = 0; alive and (pos < target.size()); ++pos)
+        {
+            if ((cursor.remaining == found[idx]->count) or (cursor.value < target[pos]))
+                alive = cursor_seek(cursor, target[pos], found[idx]->count);
+
+            if (alive and (cursor.value == target[pos]))
+                target[kept++] = target[pos];
+        }
+
+        target.resize(kept);
+    }
+
+    // All trigrams appear in the name, but they may not be contiguous.
+    const auto last = std::remove_if(target.begin(), target.end(), [&catalog, &query](const uint32_t index)
+    {
+        return memmem(catalog.lower(index), catalog.name(index).size(), query.data(), query.size()) == nullptr;
+    });
+
+    target.erase(last, target.end());
+
+}   // }}}
+
+size_t
+TrigramIndex::estimate(const std::string& query) const noexcept
+{   // {{{
+
+    std::vector<const TrigramList*> found;
+    return this->lookup(query, found) ? found[0]->count : 0;
+
+}   // }}}
+
+size_t
+TrigramIndex::bytes(void) const noexcept
+{   // {{{
+
+    return sizeof(TrigramList) * this->lists.capacity() + this->data.capacity() + sizeof(TrigramSkip) * this->skips.capacity();
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+TrigramIndex::lookup(const std::string& query, std::vector<const TrigramList*>& target) const noexcept
+{   // {{{
+
+    std::vector<uint32_t> keys;
+    collect_keys(query.data(), query.size(), keys);
+
+    target.clear();
+
+    for (const uint32_t key : keys)
+    {
+        const auto iter = std::lower_bound(this->lists.begin(), this->lists.end(), key, [](const TrigramList& list, const uint32_t k) { return list.key < k; });
+        if ((iter == this->lists.end()) or (iter->key != key))
+            return false;
+
+        target.push_back(&(*iter));
+    }
+
+    std::sort(target.begin(), target.end(), [](const TrigramList* a, const TrigramList* b) { return a->count < b->count; });
+
+    return not target.empty();
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: trigram.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "TrigramIndex" class, an inverted index from the trigrams of the     ///
+/// lower case names to the indices of the names, used for the substring search on huge         ///
+/// catalogs. The posting lists are compressed by delta + varint encoding with skip pointers.   ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef TRIGRAM_HXX
+#define TRIGRAM_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Include custom headers.
+#include "catalog.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Type definitions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+    uint32_t key;    // Trigram packed into 24 bits.
+    uint32_t count;  // Number of postings.
+    uint32_t data;   // Position of the encoded postings in the data array.
+    uint32_t skip;   // Position of the skip pointers in the skip array.
+} TrigramList;
+
+typedef struct {
+    uint32_t value;   // Last name index of the block.
+    uint32_t offset;  // Position of the next block relative to the head of the postings.
+} TrigramSkip;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class TrigramIndex
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        build(const Catalog& catalog) noexcept;
+        // [Abstract]
+        //   Build the index of all names in the given catalog. The index must be rebuilt when
+        //   the catalog is modified, because it refers to the names by their indices.
+        //
+        //   The index is left empty if the memory is not enough.
+        //
+        // [Args]
+        //   catalog (const Catalog&): [IN] Catalog to be indexed.
+
+        void
+        search(const Catalog& catalog, const std::string& query, std::vector<uint32_t>& target) const noexcept;
+        // [Abstract]
+        //   Find the names which contain the given lower case query of 3 or more characters.
+        //   The candidates are found by intersecting the posting lists of the trigrams in the
+        //   query, and then verified against the lower case arena.
+        //
+        // [Args]
+        //   catalog (const Catalog&)        : [IN]  Indexed catalog.
+        //   query   (const std::string&)    : [IN]  Lower case query.
+        //   target  (std::vector<uint32_t>&): [OUT] Indices of the matched names in ascending order.
+
+        size_t
+        estimate(const std::string& query) const noexcept;
+        // [Abstract]
+        //   Returns the upper bound of the number of the names found by "search()", that is the
+        //   length of the shortest posting list of the trigrams in the query. This is cheap
+        //   compared to "search()" because no posting is decoded.
+        //
+        // [Args]
+        //   query (const std::string&): [IN] Lower case query of 3 or more characters.
+        //
+        // [Returns]
+        //   (size_t): Number of the postings of the shortest list, or zero if nothing matches.
+
+        bool
+        empty(void) const noexcept { return this->lists.empty(); }
+        // [Abstract]
+        //   Returns true if no trigram is indexed.
+
+        size_t
+        bytes(void) const noexcept;
+        // [Abstract]
+        //   Returns the memory size of the index in bytes.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        std::vector<TrigramList> lists;
+        // Posting lists sorted by the trigram.
+
+        std::vector<uint8_t> data;
+        // Concatenated posting lists. Each list is the delta encoded name indices in ascending
+        // order, where each delta is stored in the LEB128 variable length format.
+
+        std::vector<TrigramSkip> skips;
+        // Skip pointers of every TRIGRAM_SKIP_INTERVAL postings used for seeking a list.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        bool
+        lookup(const std::string& query, std::vector<const TrigramList*>& target) const noexcept;
+        // [Abstract]
+        //   Find the posting lists of the distinct trigrams in the given query.
+        //
+        // [Args]
+        //   query  (const std::string&)               : [IN]  Lower case query of 3 or more characters.
+        //   target (std::vector<const TrigramList*>&): [OUT] Posting lists in the ascending order of length.
+        //
+        // [Returns]
+        //   (bool): False if any trigram is not indexed, that is, no name matches.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
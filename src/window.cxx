@@ -6,11 +6,19 @@
 #include "window.hxx"
 
 // Include standard libraries.
+#include <algorithm>
+#include <cstring>
 #include <string>
 
+// Include POSIX headers.
+#include <poll.h>
+
 // Include custom headers.
 #include "config.hxx"
 #include "complete.hxx"
+#include "stats.hxx"
+#include "trace.hxx"
+#include "worker.hxx"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Constants
@@ -19,6 +27,12 @@
 // Message that is shown if no matched command found.
 #define STR_COMMAND_NOT_FOUND ("Command not found")
 
+// Labels drawn at the head of each line, and their indices.
+static const char* const LABELS[] = {"Command  : ", "Candidate: ", "Error    : "};
+#define LABEL_COMMAND   (0)
+#define LABEL_CANDIDATE (1)
+#define LABEL_ERROR     (2)
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Static functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,71 +54,29 @@ is_num_or_alph(const char c)
 
 }   // }}}
 
-static Window
-init_window(Display *display)
-// [Abstract]
-//   Initialize a new window and return it.
-//
-// [Args]
-//   display (Display): [IN] X11 display.
-//
-// [Returns]
-//   (Window): Initialized new window.
-//
-{   // {{{
-
-    // Get a root window.
-    Window root = RootWindow(display, 0);
-
-    // Get the size of screen.
-    int root_width  = DisplayWidth(display, 0);
-    int root_height = DisplayHeight(display, 0);
-
-    // Get the black/white color.
-    unsigned long black = BlackPixel(display, 0);
-    unsigned long white = WhitePixel(display, 0);
-
-    // Create a new window.
-    Window window = XCreateSimpleWindow(display, root,
-            (root_width - config.window_width) / 2, (root_height - config.window_height) / 2,
-            config.window_width, config.window_height, config.window_border, white, black);
-
-    // Set window size.
-    XSizeHints hints;
-    hints.flags  = PPosition | PSize;
-    hints.x      = config.window_width;
-    hints.y      = config.window_height;
-    hints.width  = (root_width  - config.window_width)  / 2;
-    hints.height = (root_height - config.window_height) / 2;
-    XSetNormalHints(display, window, &hints);
-
-    return window;
-
-}   // }}}
-
-static XftColors
-init_xft_colors(Display* display, const Colormap cmap)
+static Rect
+union_rect(const Rect& a, const Rect& b)
 // [Abstract]
-//   Initialize colors.
+//   Returns the bounding box of the given rectangles. A rectangle of zero width is ignored.
 //
 // [Args]
-//   display (Display)       : [IN] X11 display.
-//   cmap    (const Colormap): [IN] Color map of X11.
+//   a (const Rect&): [IN] First rectangle.
+//   b (const Rect&): [IN] Second rectangle.
 //
 // [Returns]
-//   (XftColors): Collection of colors.
+//   (Rect): Bounding box.
 //
 {   // {{{
 
-    XftColors colors;
+    if (a.width <= 0) return b;
+    if (b.width <= 0) return a;
 
-    XftColorAllocName(display, DefaultVisual(display, 0), cmap, "white", &colors.white);
-    XftColorAllocName(display, DefaultVisual(display, 0), cmap, "black", &colors.black);
-    XftColorAllocName(display, DefaultVisual(display, 0), cmap, "red",   &colors.red);
-    XftColorAllocName(display, DefaultVisual(display, 0), cmap, "green", &colors.green);
-    XftColorAllocName(display, DefaultVisual(display, 0), cmap, "blue",  &colors.blue);
+    const int32_t x1 = std::min(a.x, b.x);
+    const int32_t y1 = std::min(a.y, b.y);
+    const int32_t x2 = std::max(a.x + a.width,  b.x + b.width);
+    const int32_t y2 = std::max(a.y + a.height, b.y + b.height);
 
-    return colors;
+    return {x1, y1, x2 - x1, y2 - y1};
 
 }   // }}}
 
@@ -112,31 +84,34 @@ init_xft_colors(Display* display, const Colormap cmap)
 // Constructors and descructors
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-MainWindow::MainWindow(void)
+MainWindow::MainWindow(Complete& complete, Backend& backend) : complete(complete), worker(complete), backend(backend), key_time(0), echo_time(0)
 {   // {{{
 
-    // Initialize member variables.
-    this->display  = XOpenDisplay(0);
-    this->window   = init_window(this->display);
-    this->xft_font = XftFontOpen(this->display, 0, XFT_FAMILY, XftTypeString, config.xft_fontname.c_str(), XFT_SIZE, XftTypeDouble, config.xft_fontsize, NULL);
-    this->cmap     = DefaultColormap(this->display, 0);
-    this->colors   = init_xft_colors(this->display, this->cmap);
-    this->draw     = XftDrawCreate(this->display, this->window, DefaultVisual(this->display, 0), this->cmap);
+    // Cache the widths of the labels.
+    for (size_t idx = 0; idx < 3; ++idx)
+        this->label_widths[idx] = this->backend.text_width(LABELS[idx], std::strlen(LABELS[idx]));
 
-    // Create and initialize X Window.
-    XMapWindow(this->display, this->window);
-    XFlush(this->display);
+    // The buffer is cleared by the backend.
+    for (DrawnLine& line : this->lines)
+        line.valid = false;
 
-    // Define raised event from X window.
-    XSelectInput(this->display, this->window, KeyPressMask | KeyReleaseMask | ExposureMask);
+    // Update the candidate line when the completion worker finishes the latest request.
+    this->add_watch(this->worker.fd(), [this](void)
+    {
+        if (not this->worker.on_result())
+            return;
 
-}   // }}}
+        {
+            const auto guard = this->worker.lock();
+            this->candidate  = this->complete.get(0, "");
+        }
 
-MainWindow::~MainWindow(void)
-{   // {{{
+        this->redraw_window();
+        trace_startup("candidate");
 
-    XftDrawDestroy(this->draw);
-    XCloseDisplay(this->display);
+        stats_record(STATS_KEY_TO_FRAME, this->key_time);
+        this->key_time = 0;
+    });
 
 }   // }}}
 
@@ -144,79 +119,128 @@ MainWindow::~MainWindow(void)
 // Public functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void
-MainWindow::start(int argc, char *argv[], Complete& complete)
+bool
+MainWindow::start(int argc, char *argv[], const bool resident)
 {   // {{{
 
     // Set window title.
-    XTextProperty win_prop;
-    win_prop.value    = (unsigned char*) config.window_title.c_str();
-    win_prop.encoding = XA_STRING;
-    win_prop.format   = 8;
-    win_prop.nitems   = strlen((char*) win_prop.value);
-    XSetWMProperties(display, window, &win_prop, NULL, argv, argc, NULL, NULL, NULL);
+    this->backend.set_title(argc, argv);
+
+    // Show the window immediately unless the resident mode.
+    if (resident) this->backend.flush();
+    else          this->show();
 
-    // User input.
-    std::string input;
+    trace_startup("map");
 
     //
-    XEvent event;
-    KeySym sym;
-    char   key;
+    BackendEvent event;
+    char         key;
+
+    // True if the user input is changed by the key events which are not sent to the worker yet.
+    bool changed = false;
 
     while (true)
     {
-        XNextEvent(this->display, &event);
+        // Wait for the backend events and the watched file descriptors if no event is queued.
+        // All key events queued at once are coalesced into one request of the completion.
+        if (not this->backend.pending())
+        {
+            if (changed)
+            {
+                changed = false;
+                this->worker.request(this->input);
+                this->redraw_window();
+
+                stats_record(STATS_KEY_TO_ECHO, this->echo_time);
+                this->echo_time = 0;
+                continue;
+            }
+
+            this->wait_events();
+            continue;
+        }
+
+        this->backend.next_event(event);
 
         switch (event.type)
         {
-            // Expose Event
-            case Expose:
-                redraw_window(input, complete);
+            // Expose Event: Copy the exposed region from the buffer
+            case EVENT_EXPOSE:
+                this->backend.present(union_rect(this->render(), event.rect));
+                trace_startup("expose");
                 break;
 
             // KeyPress Event
-            case KeyPress:
+            case EVENT_KEY:
 
                 // Get pressed key
-                sym = XLookupKeysym(&event.xkey, 0);
-                key = (char) sym;
+                key = event.key;
 
                 // RETURN key: Execute command and close window
                 if (key == '\r' || key == '\n')
                 {
-                    complete.exec(input);
-                    return;
+                    // The candidates of the latest input may not be computed by the worker yet.
+                    int32_t error;
+                    {
+                        const auto guard = this->worker.lock();
+                        this->complete.update(this->input);
+                        error = this->complete.exec(this->input);
+                    }
+
+                    // Keep the window and show the reason if failed to launch.
+                    if (error != 0)
+                    {
+                        this->message = std::strerror(error);
+                        this->redraw_window();
+                    }
+                    else if (not resident) return true;
+                    else this->hide();
                 }
 
                 // Printable key: Add typed key to input string
                 else if (is_num_or_alph(key))
                 {
-                    input.push_back(sym);
-                    complete.update(input);
-                    redraw_window(input, complete);
+                    this->message.clear();
+                    this->input.push_back(key);
+                    this->stamp_key();
+                    changed = true;
                 }
 
                 // ESCAPE key: Close window
                 else if (key == 27)
-                    return;
+                {
+                    if (not resident) return false;
+                    this->hide();
+                }
 
                 // BACKSPACE key: Erase the last one character from input string if exists
                 else if (key == 8) // Backspace
                 {
-                    if (input.size() > 0)
-                        input.pop_back();
+                    this->message.clear();
+
+                    if (this->input.size() > 0)
+                        this->input.pop_back();
+
+                    this->stamp_key();
+                    changed = true;
+                }
+
+                // TAB key: Replace the input with the best candidate, e.g. to complete a path
+                // and continue typing the next component of it
+                else if (key == 9)
+                {
+                    if (this->candidate.empty() or (this->candidate == this->input))
+                        break;
 
-                    complete.update(input);
-                    redraw_window(input, complete);
+                    this->message.clear();
+                    this->input = this->candidate;
+                    this->stamp_key();
+                    changed = true;
                 }
 
                 // Do nothing for other keys
                 break;
 
-            // KeyRelease Event
-            case KeyRelease: break;
-
             // Others
             default: break;
         }
@@ -224,21 +248,178 @@ MainWindow::start(int argc, char *argv[], Complete& complete)
 
 }   // }}}
 
+void
+MainWindow::show(void)
+{   // {{{
+
+    // Reset the user input and the candidates.
+    this->input.clear();
+    this->message.clear();
+    this->candidate.clear();
+    this->worker.request(this->input);
+    this->key_time = this->echo_time = 0;
+
+    // Map the window. The contents are drawn when the Expose event arrives.
+    this->backend.map();
+
+}   // }}}
+
+void
+MainWindow::hide(void)
+{   // {{{
+
+    this->backend.unmap();
+
+}   // }}}
+
+void
+MainWindow::refresh(const std::function<bool(void)>& modify)
+{   // {{{
+
+    bool changed;
+    {
+        const auto guard = this->worker.lock();
+        changed = modify();
+    }
+
+    // The candidate line is redrawn when the worker finishes.
+    if (changed)
+        this->worker.request(this->input);
+
+}   // }}}
+
+void
+MainWindow::append(std::vector<std::string>&& sorted)
+{   // {{{
+
+    this->worker.append(std::move(sorted));
+
+}   // }}}
+
+void
+MainWindow::add_watch(const int32_t fd, std::function<void(void)> callback)
+{   // {{{
+
+    this->watches.emplace_back(fd, std::move(callback));
+
+}   // }}}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Private functions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void
-MainWindow::redraw_window(const std::string& input, Complete& complete)
+MainWindow::wait_events(void)
+{   // {{{
+
+    // The first element is always the backend.
+    std::vector<struct pollfd> fds(this->watches.size() + 1);
+    fds[0] = {this->backend.fd(), POLLIN, 0};
+    for (size_t idx = 0; idx < this->watches.size(); ++idx)
+        fds[idx + 1] = {this->watches[idx].first, POLLIN, 0};
+
+    if (poll(fds.data(), fds.size(), -1) <= 0)
+        return;
+
+    // Call the callbacks of the readable file descriptors. The backend events are handled by the caller.
+    for (size_t idx = 0; idx < this->watches.size(); ++idx)
+        if (fds[idx + 1].revents & (POLLIN | POLLHUP | POLLERR))
+            this->watches[idx].second();
+
+}   // }}}
+
+void
+MainWindow::redraw_window(void)
+{   // {{{
+
+    const uint64_t start = stats_clock();
+    this->backend.present(this->render());
+    stats_record(STATS_REDRAW, start);
+
+    const uint64_t flush = stats_clock();
+    this->backend.flush();
+    stats_record(STATS_FLUSH, flush);
+
+}   // }}}
+
+void
+MainWindow::stamp_key(void)
+{   // {{{
+
+    // Keep the time of the oldest key which is not reflected yet.
+    const uint64_t now = stats_clock();
+
+    if (this->key_time  == 0) this->key_time  = now;
+    if (this->echo_time == 0) this->echo_time = now;
+
+}   // }}}
+
+Rect
+MainWindow::render(void)
 {   // {{{
 
-    XClearArea(this->display, this->window, 0, 0, config.window_width, config.window_height, false);
+    const Rect damage = this->render_line(0, LABEL_COMMAND, this->input, COLOR_WHITE);
+
+    if (this->message.empty())
+        return union_rect(damage, this->render_line(1, LABEL_CANDIDATE, this->candidate.empty() ? STR_COMMAND_NOT_FOUND : this->candidate, COLOR_GREEN));
+    else
+        return union_rect(damage, this->render_line(1, LABEL_ERROR, this->message, COLOR_RED));
+
+}   // }}}
+
+Rect
+MainWindow::render_line(const size_t index, const int32_t label, const std::string& body, const int32_t color)
+{   // {{{
+
+    DrawnLine& line = this->lines[index];
+
+    // Keep the label and the common prefix of the body if the same label is drawn.
+    size_t prefix = 0;
+    if (line.valid and (line.label == label))
+    {
+        const size_t limit = std::min(line.body.size(), body.size());
+        while ((prefix < limit) and (line.body[prefix] == body[prefix]))
+            ++prefix;
+
+        // Do not split a UTF-8 character, e.g. "é" (C3 A9) and "è" (C3 A8) share the first byte.
+        while ((prefix > 0) and ((static_cast<uint8_t>(body[prefix]) & 0xC0) == 0x80))
+            --prefix;
+
+        if ((prefix == line.body.size()) and (prefix == body.size()))
+            return {0, 0, 0, 0};
+    }
+
+    const bool    keep_label = line.valid and (line.label == label);
+    const int32_t left       = config.text_left_margin;
+    const int32_t baseline   = (index == 0) ? config.text_top1_margin : config.text_top2_margin;
+    const int32_t top        = std::max(baseline - this->backend.ascent(), 0);
+    const int32_t height     = std::min(baseline + this->backend.descent(), config.window_height) - top;
+    const int32_t x_body     = left + this->label_widths[label] + this->backend.text_width(body.c_str(), prefix);
+    const int32_t x_start    = keep_label ? x_body : 0;
+    const int32_t x_end      = x_body + this->backend.text_width(body.c_str() + prefix, body.size() - prefix);
+
+    // The glyphs may overhang their advance width, so the damaged region is extended by the
+    // maximum advance width of the font.
+    const int32_t x_damage = std::min(std::max(x_end, line.valid ? line.end : 0) + this->backend.max_advance(), config.window_width);
+
+    if (height <= 0 or x_damage <= x_start)
+        return {0, 0, 0, 0};
+
+    // Clear the changed part of the line and draw the new text.
+    this->backend.fill({x_start, top, config.window_width - x_start, height});
+
+    if (not keep_label)
+        this->backend.draw_text(color, left, baseline, LABELS[label], std::strlen(LABELS[label]));
+
+    this->backend.draw_text(color, x_body, baseline, body.c_str() + prefix, body.size() - prefix);
 
-    const std::string msg1 = "Command  : " + input;
-    const std::string msg2 = "Candidate: " + complete.get(0, STR_COMMAND_NOT_FOUND);
+    // Remember the drawn contents.
+    line.valid = true;
+    line.label = label;
+    line.end   = x_end;
+    line.body  = body;
 
-    XftDrawStringUtf8(this->draw, &this->colors.white, this->xft_font, config.text_left_margin, config.text_top1_margin, (FcChar8*) msg1.c_str(), msg1.size());
-    XftDrawStringUtf8(this->draw, &this->colors.green, this->xft_font, config.text_left_margin, config.text_top2_margin, (FcChar8*) msg2.c_str(), msg2.size());
+    return {x_start, top, x_damage - x_start, height};
 
 }   // }}}
 
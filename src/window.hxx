@@ -1,7 +1,7 @@
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 /// C++ header file: window.hxx                                                                  ///
 ///                                                                                              ///
-/// This file provides the "MainWindow" class that manages the X11 window.                       ///
+/// This file provides the "MainWindow" class that manages the main window through a backend.    ///
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 #ifndef WINDOW_HXX
@@ -9,27 +9,26 @@
 
 // Include the headers of STL.
 #include <cstdint>
-
-// Include X11 headers.
-#include <X11/Xlib.h>
-#include <X11/Xft/Xft.h>
-#include <X11/Xutil.h>
-#include <X11/Xatom.h>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
 
 // Include custom headers.
+#include "backend.hxx"
 #include "complete.hxx"
+#include "worker.hxx"
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Type definitions
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
 typedef struct {
-    XftColor white;
-    XftColor black;
-    XftColor red;
-    XftColor green;
-    XftColor blue;
-} XftColors;
+    bool        valid;
+    int32_t     label;
+    int32_t     end;
+    std::string body;
+} DrawnLine;
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Class definition
@@ -43,22 +42,65 @@ class MainWindow
         // Constructors and descructors
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-         MainWindow(void);
-        ~MainWindow(void);
+        MainWindow(Complete& complete, Backend& backend);
 
         ////////////////////////////////////////////////////////////////////////////////////////////
         // Member functions
         ////////////////////////////////////////////////////////////////////////////////////////////
 
+        bool
+        start(int32_t argc, char *argv[], const bool resident = false);
+        // [Abstract]
+        //   Start GUI loop. The window is shown immediately and the loop exits when a command is
+        //   executed or canceled, except for the resident mode where the window is initially
+        //   hidden and hides itself instead of exiting.
+        //
+        // [Args]
+        //   argc     (int32_t)   : [IN] The number of command line arguments.
+        //   argv     (char*[])   : [IN] The values of command line arguments.
+        //   resident (const bool): [IN] Keep the window and loop after the command execution.
+        //
+        // [Returns]
+        //   (bool): True if a command is executed, false if canceled.
+
+        void
+        show(void);
+        // [Abstract]
+        //   Clear the user input and map the window.
+
+        void
+        hide(void);
+        // [Abstract]
+        //   Unmap the window.
+
+        void
+        refresh(const std::function<bool(void)>& modify);
+        // [Abstract]
+        //   Call the given function with the exclusive access to the Complete instance, and
+        //   recompute the candidates of the current user input if it returns true.
+        //   This function should be used to change the command names.
+        //
+        // [Args]
+        //   modify (const std::function<bool(void)>&): [IN] Function that returns true if the command names are changed.
+
+        void
+        append(std::vector<std::string>&& sorted);
+        // [Abstract]
+        //   Add the given names to the candidates. The candidate line is redrawn when the
+        //   completion worker finishes. This function can be called from any thread.
+        //
+        // [Args]
+        //   sorted (std::vector<std::string>&&): [IN] Names sorted in the dictionary order without duplication.
+
         void
-        start(int32_t argc, char *argv[], Complete& complete);
+        add_watch(const int32_t fd, std::function<void(void)> callback);
         // [Abstract]
-        //   Start GUI loop.
+        //   Register a file descriptor which is polled in the GUI loop together with the X
+        //   connection. The callback is called when the descriptor becomes readable.
         //
         // [Args]
-        //   argc     (int32_t)  : [IN] The number of command line arguments.
-        //   argv     (char*[])  : [IN] The values of command line arguments.
-        //   complete (Complete&): [IN] Complete instance.
+        //   fd       (const int32_t)            : [IN] File descriptor to be watched.
+        //   callback (std::function<void(void)>): [IN] Function called when the fd is readable.
 
     private:
 
@@ -66,36 +108,85 @@ class MainWindow
         // Private member variables
         ////////////////////////////////////////////////////////////////////////////////////////////
 
-        Display* display;
-        // Pointer to the X11 display.
+        Complete& complete;
+        // Complete instance which is accessed under the lock of "this->worker".
+
+        Worker worker;
+        // Completion worker running on a background thread.
+
+        Backend& backend;
+        // Window system backend that holds the off-screen buffer. The window is updated by
+        // copying the damaged region of the buffer.
+
+        int32_t label_widths[3];
+        // Cached widths of the line labels ("Command  : ", "Candidate: " and "Error    : ").
 
-        Window window;
-        // Window instance.
+        DrawnLine lines[2];
+        // Contents of each line currently drawn in the buffer.
 
-        XftFont* xft_font;
-        // Primary data structure of Xft.
+        std::string input;
+        // User input.
 
-        Colormap cmap;
-        // Colormap of X11.
+        std::string candidate;
+        // The best candidate of the latest completed request, or empty if not found.
 
-        XftColors colors;
-        // Collection of primary colors.
+        std::string message;
+        // Error message shown instead of the candidate, or empty.
 
-        XftDraw* draw;
-        // Xft data structure used for rendering a font.
+        std::vector<std::pair<int32_t, std::function<void(void)>>> watches;
+        // File descriptors polled in the GUI loop and their callbacks.
+
+        uint64_t key_time;
+        // Time of the oldest key event which is not reflected to the candidate line yet, or zero.
+        // Always zero if the latency statistics are disabled.
+
+        uint64_t echo_time;
+        // Time of the oldest key event which is not reflected to the input line yet, or zero.
 
         ////////////////////////////////////////////////////////////////////////////////////////////
         // Private functions
         ////////////////////////////////////////////////////////////////////////////////////////////
 
         void
-        redraw_window(const std::string& input, Complete& complete);
+        wait_events(void);
+        // [Abstract]
+        //   Block until the backend or one of the watched file descriptors becomes readable,
+        //   and call the callbacks of the readable watched file descriptors.
+
+        void
+        redraw_window(void);
         // [Abstract]
-        //   Redraw the window.
+        //   Update the buffer, copy the changed region to the window and flush it.
+
+        void
+        stamp_key(void);
+        // [Abstract]
+        //   Remember the time of the key event which changed the user input for the latency
+        //   statistics.
+
+        Rect
+        render(void);
+        // [Abstract]
+        //   Update the buffer to the current input and candidate. Only the part of each line
+        //   after the unchanged prefix is redrawn.
+        //
+        // [Returns]
+        //   (Rect): Changed region of the buffer (zero width if nothing is changed).
+
+        Rect
+        render_line(const size_t index, const int32_t label, const std::string& body, const int32_t color);
+        // [Abstract]
+        //   Update one line of the buffer.
         //
         // [Args]
-        //   input    (const std::string&): [IN] User input.
-        //   complete (Complete&)         : [IN] Complete instance.
+        //   index (const size_t)      : [IN] Line number (0 or 1).
+        //   label (const int32_t)     : [IN] Label index of the line.
+        //   body  (const std::string&): [IN] Text following the label.
+        //   color (const int32_t)     : [IN] Text color (one of COLOR_*).
+        //
+        // [Returns]
+        //   (Rect): Changed region of the buffer (zero width if nothing is changed).
+
 };
 
 #endif
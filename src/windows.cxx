@@ -0,0 +1,240 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: windows.cxx                                                                 ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "windows.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+
+// Include X11 headers.
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+
+// Include custom headers.
+#include "config.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Lifetime of the cached window titles [msec].
+#define WINDOWS_CACHE_LIFETIME (1000)
+
+// Maximum number of the windows read from "_NET_CLIENT_LIST".
+#define WINDOWS_MAX_CLIENTS (1024)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static variables
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Connection of the provider, whose errors are ignored.
+static Display* provider_display = nullptr;
+
+// Error handler installed before the provider.
+static int (*previous_handler)(Display*, XErrorEvent*) = nullptr;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static int
+handle_error(Display* display, XErrorEvent* event)
+// [Abstract]
+//   Ignore the errors of the provider, which occur when a window is closed while its title is
+//   being read. The other errors are handled by the previous handler.
+//
+// [Args]
+//   display (Display*)    : [IN] Connection to the X server.
+//   event   (XErrorEvent*): [IN] Error event.
+//
+// [Returns]
+//   (int): Ignored.
+//
+{   // {{{
+
+    if ((display == provider_display) or (previous_handler == nullptr))
+        return 0;
+
+    return previous_handler(display, event);
+
+}   // }}}
+
+static std::string
+read_title(Display* display, const Window window, const Atom net_wm_name, const Atom utf8_string) noexcept
+// [Abstract]
+//   Returns the title of the given window. The UTF-8 title of EWMH is preferred.
+//
+// [Args]
+//   display     (Display*)    : [IN] Connection to the X server.
+//   window      (const Window): [IN] Target window.
+//   net_wm_name (const Atom)  : [IN] Atom of "_NET_WM_NAME".
+//   utf8_string (const Atom)  : [IN] Atom of "UTF8_STRING".
+//
+// [Returns]
+//   (std::string): Title of the window, or an empty string if not available.
+//
+{   // {{{
+
+    std::string title;
+
+    Atom           type;
+    int            format;
+    unsigned long  n_items, remaining;
+    unsigned char* data = nullptr;
+
+    if ((XGetWindowProperty(display, window, net_wm_name, 0, 1024, False, utf8_string, &type, &format, &n_items, &remaining, &data) == Success) and (data != nullptr))
+        title.assign(reinterpret_cast<const char*>(data), n_items);
+
+    if (data != nullptr)
+        XFree(data);
+
+    // Fall back to the ICCCM title.
+    char* name = nullptr;
+    if (title.empty() and (XFetchName(display, window, &name) != 0) and (name != nullptr))
+        title = name;
+
+    if (name != nullptr)
+        XFree(name);
+
+    return title;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+WindowProvider::WindowProvider(const Config& settings) : settings(settings), display(nullptr), failed(false)
+{   // {{{
+
+    // Xlib is used by both the GUI thread and the provider thread. This must be the first call
+    // of Xlib, therefore the instance should be created before the main window.
+    XInitThreads();
+    previous_handler = XSetErrorHandler(handle_error);
+
+}   // }}}
+
+WindowProvider::~WindowProvider(void)
+{   // {{{
+
+    if (this->display != nullptr)
+        XCloseDisplay(this->display);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+WindowProvider::query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept
+{   // {{{
+
+    // Open the connection on the provider thread so that the startup is not delayed.
+    if ((this->display == nullptr) and (not this->failed))
+    {
+        provider_display = this->display = XOpenDisplay(nullptr);
+        this->failed     = (this->display == nullptr);
+    }
+
+    if (this->display == nullptr)
+        return;
+
+    // The titles are cached for a while because they are queried for every key input.
+    if (std::chrono::steady_clock::now() - this->updated > std::chrono::milliseconds(WINDOWS_CACHE_LIFETIME))
+        this->update_titles();
+
+    std::string lower(input);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](const char c) { return (('A' <= c) and (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c; });
+
+    for (const auto& [window, title] : this->titles)
+    {
+        if (cancelled and cancelled())
+            return;
+
+        int32_t score;
+        if (match_label(input, lower, title, score, this->settings))
+            items.push_back({title, std::to_string(window), score});
+    }
+
+    // The windows are listed in "_NET_CLIENT_LIST", i.e. in the mapping order, which is kept for the same score.
+    std::stable_sort(items.begin(), items.end(), [](const ProviderItem& a, const ProviderItem& b) { return a.score > b.score; });
+
+    if (items.size() > PROVIDER_MAX_ITEMS)
+        items.resize(PROVIDER_MAX_ITEMS);
+
+}   // }}}
+
+int32_t
+WindowProvider::launch(const ProviderItem& item) noexcept
+{   // {{{
+
+    // This function is called on the GUI thread, which must not use the connection of the
+    // provider thread.
+    Display* display = XOpenDisplay(nullptr);
+    if (display == nullptr)
+        return ECONNREFUSED;
+
+    const Window root = DefaultRootWindow(display);
+
+    // Ask the window manager to activate the window as a pager does (source indication 2).
+    XEvent event = {};
+    event.xclient.type         = ClientMessage;
+    event.xclient.window       = static_cast<Window>(std::strtoul(item.action.c_str(), nullptr, 10));
+    event.xclient.message_type = XInternAtom(display, "_NET_ACTIVE_WINDOW", False);
+    event.xclient.format       = 32;
+    event.xclient.data.l[0]    = 2;
+    event.xclient.data.l[1]    = CurrentTime;
+
+    XSendEvent(display, root, False, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+    XCloseDisplay(display);
+
+    return 0;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+WindowProvider::update_titles(void) noexcept
+{   // {{{
+
+    const Atom net_client_list = XInternAtom(this->display, "_NET_CLIENT_LIST", False);
+    const Atom net_wm_name     = XInternAtom(this->display, "_NET_WM_NAME",     False);
+    const Atom utf8_string     = XInternAtom(this->display, "UTF8_STRING",      False);
+
+    this->titles.clear();
+    this->updated = std::chrono::steady_clock::now();
+
+    Atom           type;
+    int            format;
+    unsigned long  n_items, remaining;
+    unsigned char* data = nullptr;
+
+    if ((XGetWindowProperty(this->display, DefaultRootWindow(this->display), net_client_list, 0, WINDOWS_MAX_CLIENTS, False, XA_WINDOW,
+                            &type, &format, &n_items, &remaining, &data) != Success) or (data == nullptr))
+        return;
+
+    // The 32-bit items of the property are returned as an array of long.
+    const Window* windows = reinterpret_cast<const Window*>(data);
+
+    for (unsigned long idx = 0; idx < n_items; ++idx)
+    {
+        const std::string title = read_title(this->display, windows[idx], net_wm_name, utf8_string);
+
+        // Skip the untitled windows and the window of this software.
+        if ((not title.empty()) and (title != this->settings.window_title))
+            this->titles.emplace_back(windows[idx], title);
+    }
+
+    XFree(data);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,88 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: windows.hxx                                                                 ///
+///                                                                                              ///
+/// This file provides the "WindowProvider" class, the provider of the titles of the open        ///
+/// windows listed in "_NET_CLIENT_LIST" of the root window. The selected window is activated    ///
+/// by "_NET_ACTIVE_WINDOW" instead of launching a command.                                      ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WINDOWS_HXX
+#define WINDOWS_HXX
+
+// Include the headers of STL.
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Include X11 headers.
+#include <X11/Xlib.h>
+
+// Include custom headers.
+#include "provider.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class WindowProvider : public Provider
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         explicit WindowProvider(const Config& settings);
+        ~WindowProvider(void);
+        // [Abstract]
+        //   Construct the provider with the given config values, which must outlive this instance.
+        //   This must be done before any other call of Xlib.
+        //
+        // [Args]
+        //   settings (const Config&): [IN] Config values.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "provider.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        query(const std::string& input, std::vector<ProviderItem>& items, const std::function<bool(void)>& cancelled) noexcept override;
+
+        int32_t
+        launch(const ProviderItem& item) noexcept override;
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const Config& settings;
+        // Config values (the matching mode and the title of the main window).
+
+        Display* display;
+        // Connection to the X server used only on the provider thread (opened lazily).
+
+        bool failed;
+        // True if failed to open the connection.
+
+        std::vector<std::pair<Window, std::string>> titles;
+        // Cached titles of the open windows.
+
+        std::chrono::steady_clock::time_point updated;
+        // Time when "this->titles" is updated.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        update_titles(void) noexcept;
+        // [Abstract]
+        //   Read the list of the open windows and their titles from the X server.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
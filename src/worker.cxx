@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: worker.cxx                                                                  ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "worker.hxx"
+
+// Include POSIX headers.
+#include <fcntl.h>
+#include <unistd.h>
+
+// Include custom headers.
+#include "stats.hxx"
+#include "trace.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+Worker::Worker(Complete& complete)
+    : complete(complete), requested(0), loaded(false), stop(false), latest(0), done(0), waiters(0), pipe_fds{-1, -1}
+{   // {{{
+
+    // Both ends are non-blocking. The notification is just a hint, so a full pipe is harmless.
+    if (pipe2(this->pipe_fds, O_NONBLOCK | O_CLOEXEC) != 0)
+        this->pipe_fds[0] = this->pipe_fds[1] = -1;
+
+    // Merge the late results of the providers.
+    this->complete.set_provider_callback([this](void) { this->retry(); });
+
+    this->thread = std::thread(&Worker::run, this);
+
+}   // }}}
+
+Worker::~Worker(void)
+{   // {{{
+
+    // The providers may outlive this instance.
+    this->complete.set_provider_callback(nullptr);
+
+    {
+        std::lock_guard<std::mutex> guard(this->request_mutex);
+        this->stop = true;
+        this->latest.store(++this->requested);
+    }
+
+    this->request_cond.notify_one();
+    this->thread.join();
+
+    if (this->pipe_fds[0] >= 0) close(this->pipe_fds[0]);
+    if (this->pipe_fds[1] >= 0) close(this->pipe_fds[1]);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+Worker::request(const std::string& input) noexcept
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->request_mutex);
+        this->pending = input;
+        this->latest.store(++this->requested);
+    }
+
+    this->request_cond.notify_one();
+
+}   // }}}
+
+void
+Worker::append(std::vector<std::string>&& sorted) noexcept
+{   // {{{
+
+    // The latest user input is requested again with a new generation number.
+    {
+        std::lock_guard<std::mutex> guard(this->request_mutex);
+        this->batches.push_back(std::move(sorted));
+        this->latest.store(++this->requested);
+    }
+
+    this->request_cond.notify_one();
+
+}   // }}}
+
+bool
+Worker::on_result(void) noexcept
+{   // {{{
+
+    char buffer[64];
+    while (read(this->pipe_fds[0], buffer, sizeof(buffer)) > 0);
+
+    // The results of the older requests are ignored because they are overwritten soon.
+    return this->done.load() == this->latest.load();
+
+}   // }}}
+
+std::unique_lock<std::mutex>
+Worker::lock(void) noexcept
+{   // {{{
+
+    // Wait for the command names.
+    {
+        std::unique_lock<std::mutex> guard(this->request_mutex);
+        this->request_cond.wait(guard, [this](void) { return this->loaded; });
+    }
+
+    this->waiters.fetch_add(1);
+    std::unique_lock<std::mutex> guard(this->complete_mutex);
+    this->waiters.fetch_sub(1);
+
+    return guard;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+Worker::retry(void) noexcept
+{   // {{{
+
+    {
+        std::lock_guard<std::mutex> guard(this->request_mutex);
+        this->latest.store(++this->requested);
+    }
+
+    this->request_cond.notify_one();
+
+}   // }}}
+
+void
+Worker::run(void) noexcept
+{   // {{{
+
+    // Load the command names while the GUI thread creates the window.
+    {
+        std::lock_guard<std::mutex> guard(this->complete_mutex);
+        this->complete.load();
+        trace_startup("index");
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(this->request_mutex);
+        this->loaded = true;
+    }
+
+    this->request_cond.notify_all();
+
+    while (true)
+    {
+        std::string                           input;
+        uint64_t                              generation;
+        std::vector<std::vector<std::string>> names;
+
+        // Wait for a request which is not completed yet.
+        {
+            std::unique_lock<std::mutex> guard(this->request_mutex);
+            this->request_cond.wait(guard, [this](void) { return this->stop or (this->requested != this->done.load()); });
+
+            if (this->stop)
+                return;
+
+            input      = this->pending;
+            generation = this->requested;
+            names.swap(this->batches);
+        }
+
+        // Let the waiting thread take the Complete instance first.
+        while (this->waiters.load() > 0)
+            std::this_thread::yield();
+
+        // The matching is abandoned if a newer request arrives or another thread is waiting for
+        // the Complete instance. In the latter case, the same request is retried later.
+        bool           completed;
+        const uint64_t start = stats_clock();
+        {
+            std::lock_guard<std::mutex> guard(this->complete_mutex);
+
+            // The added names are not cancelled.
+            for (const std::vector<std::string>& sorted : names)
+                this->complete.append(sorted);
+
+            completed = this->complete.update(input, [this, generation](void) { return (this->latest.load(std::memory_order_relaxed) != generation) or (this->waiters.load(std::memory_order_relaxed) > 0); });
+        }
+
+        // The cancelled matching is not counted because it is partial.
+        if (not completed)
+            continue;
+
+        stats_record(STATS_UPDATE, start);
+        this->done.store(generation);
+
+        // Wake up the GUI loop.
+        const char byte = 0;
+        if (write(this->pipe_fds[1], &byte, 1) < 0) {}
+    }
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,152 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: worker.hxx                                                                  ///
+///                                                                                              ///
+/// This file provides the "Worker" class that loads the command names and runs the completion   ///
+/// on a background thread so that the GUI loop is never blocked by them.                        ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WORKER_HXX
+#define WORKER_HXX
+
+// Include the headers of STL.
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include custom headers.
+#include "complete.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class Worker
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        explicit Worker(Complete& complete);
+        ~Worker(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        int32_t
+        fd(void) const noexcept { return this->pipe_fds[0]; }
+        // [Abstract]
+        //   Returns the read end of the self-pipe. It becomes readable when a request is
+        //   completed, and then "on_result()" should be called.
+
+        void
+        request(const std::string& input) noexcept;
+        // [Abstract]
+        //   Ask the worker thread to update the candidates for the given user input. The request
+        //   in progress is cancelled because its result is no longer needed.
+        //
+        // [Args]
+        //   input (const std::string&): [IN] User input.
+
+        void
+        append(std::vector<std::string>&& sorted) noexcept;
+        // [Abstract]
+        //   Ask the worker thread to add the given names to the Complete instance and update the
+        //   candidates of the latest request again. This function can be called from any thread.
+        //
+        // [Args]
+        //   sorted (std::vector<std::string>&&): [IN] Names sorted in the dictionary order without duplication.
+
+        bool
+        on_result(void) noexcept;
+        // [Abstract]
+        //   Consume the notifications of the self-pipe.
+        //
+        // [Returns]
+        //   (bool): True if the candidates of the latest request are available.
+
+        std::unique_lock<std::mutex>
+        lock(void) noexcept;
+        // [Abstract]
+        //   Get the exclusive access to the Complete instance. The matching in progress is
+        //   interrupted and resumed after the returned lock is released. This function blocks
+        //   until the command names are loaded.
+        //
+        // [Returns]
+        //   (std::unique_lock<std::mutex>): Lock of the Complete instance.
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        Complete& complete;
+        // Complete instance which is accessed only under "this->complete_mutex".
+
+        std::mutex complete_mutex;
+        // Mutex of the Complete instance.
+
+        std::mutex request_mutex;
+        // Mutex of "this->pending", "this->batches", "this->requested", "this->loaded" and "this->stop".
+
+        std::condition_variable request_cond;
+        // Condition variable notified when a new request arrives or the command names are loaded.
+
+        std::string pending;
+        // User input of the latest request.
+
+        std::vector<std::vector<std::string>> batches;
+        // Names to be added to the Complete instance.
+
+        uint64_t requested;
+        // Generation number of the latest request.
+
+        bool loaded;
+        // True if the command names are loaded by the worker thread.
+
+        bool stop;
+        // True if the worker thread should exit.
+
+        std::atomic<uint64_t> latest;
+        // Copy of "this->requested" that can be read without the lock.
+
+        std::atomic<uint64_t> done;
+        // Generation number of the last completed request.
+
+        std::atomic<int32_t> waiters;
+        // Number of threads waiting for "this->complete_mutex" in "lock()".
+
+        int32_t pipe_fds[2];
+        // Self-pipe used for notifying the GUI loop of the completion.
+
+        std::thread thread;
+        // Worker thread.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        void
+        retry(void) noexcept;
+        // [Abstract]
+        //   Ask the worker thread to update the candidates of the latest request again, e.g. when
+        //   a provider returns the result after the deadline. This function can be called from
+        //   any thread.
+
+        void
+        run(void) noexcept;
+        // [Abstract]
+        //   Main loop of the worker thread. The command names are loaded first, and the requests
+        //   arrived meanwhile are coalesced into the latest one.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
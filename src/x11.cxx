@@ -0,0 +1,211 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: x11.cxx                                                                     ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "x11.hxx"
+
+// Include the headers of STL.
+#include <cstring>
+
+// Include custom headers.
+#include "config.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Names of the colors of the index COLOR_*.
+static const char* const COLOR_NAMES[] = {"black", "white", "red", "green", "blue"};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static Window
+init_window(Display *display)
+// [Abstract]
+//   Initialize a new window and return it.
+//
+// [Args]
+//   display (Display): [IN] X11 display.
+//
+// [Returns]
+//   (Window): Initialized new window.
+//
+{   // {{{
+
+    // Get a root window.
+    Window root = RootWindow(display, 0);
+
+    // Get the size of screen.
+    int root_width  = DisplayWidth(display, 0);
+    int root_height = DisplayHeight(display, 0);
+
+    // Get the black/white color.
+    unsigned long black = BlackPixel(display, 0);
+    unsigned long white = WhitePixel(display, 0);
+
+    // Create a new window.
+    Window window = XCreateSimpleWindow(display, root,
+            (root_width - config.window_width) / 2, (root_height - config.window_height) / 2,
+            config.window_width, config.window_height, config.window_border, white, black);
+
+    // Set window size.
+    XSizeHints hints;
+    hints.flags  = PPosition | PSize;
+    hints.x      = config.window_width;
+    hints.y      = config.window_height;
+    hints.width  = (root_width  - config.window_width)  / 2;
+    hints.height = (root_height - config.window_height) / 2;
+    XSetNormalHints(display, window, &hints);
+
+    return window;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+X11Backend::X11Backend(void)
+{   // {{{
+
+    // Initialize member variables.
+    this->display  = XOpenDisplay(0);
+    this->window   = init_window(this->display);
+    this->xft_font = XftFontOpen(this->display, 0, XFT_FAMILY, XftTypeString, config.xft_fontname.c_str(), XFT_SIZE, XftTypeDouble, config.xft_fontsize, NULL);
+    this->cmap     = DefaultColormap(this->display, 0);
+
+    for (size_t idx = 0; idx < N_COLORS; ++idx)
+        XftColorAllocName(this->display, DefaultVisual(this->display, 0), this->cmap, COLOR_NAMES[idx], &this->colors[idx]);
+
+    // Create the off-screen buffer. All drawing goes to the buffer and the window is updated by
+    // copying from it, therefore the window background is not painted by the X server.
+    this->buffer = XCreatePixmap(this->display, this->window, config.window_width, config.window_height, DefaultDepth(this->display, 0));
+    this->gc     = XCreateGC(this->display, this->buffer, 0, nullptr);
+    this->draw   = XftDrawCreate(this->display, this->buffer, DefaultVisual(this->display, 0), this->cmap);
+    XSetGraphicsExposures(this->display, this->gc, false);
+    XSetWindowBackgroundPixmap(this->display, this->window, None);
+
+    // Clear the buffer.
+    this->fill({0, 0, config.window_width, config.window_height});
+
+    // Define raised event from X window.
+    XSelectInput(this->display, this->window, KeyPressMask | KeyReleaseMask | ExposureMask);
+
+}   // }}}
+
+X11Backend::~X11Backend(void)
+{   // {{{
+
+    XftDrawDestroy(this->draw);
+    XFreeGC(this->display, this->gc);
+    XFreePixmap(this->display, this->buffer);
+    XCloseDisplay(this->display);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void
+X11Backend::next_event(BackendEvent& event) noexcept
+{   // {{{
+
+    XEvent xevent;
+    XNextEvent(this->display, &xevent);
+
+    event.type = EVENT_NONE;
+
+    switch (xevent.type)
+    {
+        case Expose:
+            event.type = EVENT_EXPOSE;
+            event.rect = {xevent.xexpose.x, xevent.xexpose.y, xevent.xexpose.width, xevent.xexpose.height};
+            break;
+
+        case KeyPress:
+            event.type = EVENT_KEY;
+            event.key  = (char) XLookupKeysym(&xevent.xkey, 0);
+            break;
+
+        default: break;
+    }
+
+}   // }}}
+
+void
+X11Backend::set_title(int32_t argc, char *argv[]) noexcept
+{   // {{{
+
+    XTextProperty win_prop;
+    win_prop.value    = (unsigned char*) config.window_title.c_str();
+    win_prop.encoding = XA_STRING;
+    win_prop.format   = 8;
+    win_prop.nitems   = strlen((char*) win_prop.value);
+    XSetWMProperties(this->display, this->window, &win_prop, NULL, argv, argc, NULL, NULL, NULL);
+
+}   // }}}
+
+void
+X11Backend::map(void) noexcept
+{   // {{{
+
+    XMapRaised(this->display, this->window);
+    XFlush(this->display);
+
+}   // }}}
+
+void
+X11Backend::unmap(void) noexcept
+{   // {{{
+
+    XUnmapWindow(this->display, this->window);
+    XFlush(this->display);
+
+}   // }}}
+
+int32_t
+X11Backend::text_width(const char* text, const size_t size) noexcept
+{   // {{{
+
+    if (size == 0)
+        return 0;
+
+    // The glyph metrics are cached by Xft, therefore this does not make a round trip to the X server.
+    XGlyphInfo extents;
+    XftTextExtentsUtf8(this->display, this->xft_font, (const FcChar8*) text, size, &extents);
+    return extents.xOff;
+
+}   // }}}
+
+void
+X11Backend::fill(const Rect& rect) noexcept
+{   // {{{
+
+    XftDrawRect(this->draw, &this->colors[COLOR_BLACK], rect.x, rect.y, rect.width, rect.height);
+
+}   // }}}
+
+void
+X11Backend::draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept
+{   // {{{
+
+    XftDrawStringUtf8(this->draw, &this->colors[color], this->xft_font, x, baseline, (const FcChar8*) text, size);
+
+}   // }}}
+
+void
+X11Backend::present(const Rect& rect) noexcept
+{   // {{{
+
+    if (rect.width <= 0)
+        return;
+
+    XCopyArea(this->display, this->buffer, this->window, this->gc, rect.x, rect.y, rect.width, rect.height, rect.x, rect.y);
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
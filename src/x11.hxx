@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: x11.hxx                                                                     ///
+///                                                                                              ///
+/// This file provides the "X11Backend" class, the backend of the main window for the X server   ///
+/// which renders the text with Xft.                                                             ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11_HXX
+#define X11_HXX
+
+// Include X11 headers.
+#include <X11/Xlib.h>
+#include <X11/Xft/Xft.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+
+// Include custom headers.
+#include "backend.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class X11Backend : public Backend
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         X11Backend(void);
+        ~X11Backend(void);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "backend.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        int32_t
+        fd(void) const noexcept override { return ConnectionNumber(this->display); }
+
+        bool
+        pending(void) noexcept override { return XPending(this->display) > 0; }
+
+        void
+        next_event(BackendEvent& event) noexcept override;
+
+        void
+        set_title(int32_t argc, char *argv[]) noexcept override;
+
+        void
+        map(void) noexcept override;
+
+        void
+        unmap(void) noexcept override;
+
+        void
+        flush(void) noexcept override { XFlush(this->display); }
+
+        int32_t
+        ascent(void) const noexcept override { return this->xft_font->ascent; }
+
+        int32_t
+        descent(void) const noexcept override { return this->xft_font->descent; }
+
+        int32_t
+        max_advance(void) const noexcept override { return this->xft_font->max_advance_width; }
+
+        int32_t
+        text_width(const char* text, const size_t size) noexcept override;
+
+        void
+        fill(const Rect& rect) noexcept override;
+
+        void
+        draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept override;
+
+        void
+        present(const Rect& rect) noexcept override;
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        Display* display;
+        // Pointer to the X11 display.
+
+        Window window;
+        // Window instance.
+
+        XftFont* xft_font;
+        // Primary data structure of Xft.
+
+        Colormap cmap;
+        // Colormap of X11.
+
+        XftColor colors[N_COLORS];
+        // Colors of the index COLOR_*.
+
+        Pixmap buffer;
+        // Off-screen buffer that holds the window contents. The window is updated by copying
+        // the damaged region of this buffer.
+
+        GC gc;
+        // Graphics context used for copying the buffer to the window.
+
+        XftDraw* draw;
+        // Xft data structure used for rendering a font to the buffer.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
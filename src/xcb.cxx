@@ -0,0 +1,553 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ source file: xcb.cxx                                                                     ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Include the primary header.
+#include "xcb.hxx"
+
+// Include the headers of STL.
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+// Include POSIX headers.
+#include <unistd.h>
+
+// Include fontconfig headers.
+#include <fontconfig/fontconfig.h>
+
+// Include custom headers.
+#include "config.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constants
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Colors of the index COLOR_* (0xRRGGBB), which are the same as the X11 color names.
+static const uint32_t COLOR_VALUES[] = {0x000000, 0xFFFFFF, 0xFF0000, 0x00FF00, 0x0000FF};
+
+// Flags of WM_NORMAL_HINTS (PPosition and PSize) and the number of its fields.
+#define SIZE_HINTS_FLAGS    ((1 << 2) | (1 << 3))
+#define SIZE_HINTS_N_FIELDS (18)
+
+// Size of the header of the PutImage request in bytes.
+#define PUT_IMAGE_HEADER (24)
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Static functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void
+exit_with_message(const char* message) noexcept
+// [Abstract]
+//   Print the given message and exit as well as the default error handler of Xlib.
+//
+// [Args]
+//   message (const char*): [IN] Error message.
+//
+{   // {{{
+
+    std::cout << "\033[33mHiRuGe: " << message << "\033[m" << std::endl;
+    std::exit(EXIT_FAILURE);
+
+}   // }}}
+
+static uint32_t
+decode_utf8(const char* text, const size_t size, size_t& pos) noexcept
+// [Abstract]
+//   Decode one code point of the given UTF-8 text and advance the position. An invalid byte
+//   is decoded as itself.
+//
+// [Args]
+//   text (const char*) : [IN]     UTF-8 text.
+//   size (const size_t): [IN]     Size of the text in bytes.
+//   pos  (size_t&)     : [IN/OUT] Position of the code point.
+//
+// [Returns]
+//   (uint32_t): Code point.
+//
+{   // {{{
+
+    const uint8_t lead = static_cast<uint8_t>(text[pos++]);
+
+    const size_t n_trails = (lead >= 0xF0) ? 3 : (lead >= 0xE0) ? 2 : (lead >= 0xC0) ? 1 : 0;
+    uint32_t     code     = (n_trails == 0) ? lead : (lead & (0x3F >> n_trails));
+
+    for (size_t idx = 0; (idx < n_trails) and (pos < size) and ((static_cast<uint8_t>(text[pos]) & 0xC0) == 0x80); ++idx)
+        code = (code << 6) | (static_cast<uint8_t>(text[pos++]) & 0x3F);
+
+    return code;
+
+}   // }}}
+
+static uint32_t
+to_pixel(const uint32_t rgb, const uint32_t masks[3]) noexcept
+// [Abstract]
+//   Convert the given color to the pixel value of the TrueColor visual of the given masks.
+//
+// [Args]
+//   rgb   (const uint32_t)  : [IN] Color (0xRRGGBB).
+//   masks (const uint32_t[]): [IN] Red, green and blue masks of the visual.
+//
+// [Returns]
+//   (uint32_t): Pixel value.
+//
+{   // {{{
+
+    uint32_t pixel = 0;
+
+    for (size_t idx = 0; idx < 3; ++idx)
+    {
+        const uint32_t value = (rgb >> (16 - 8 * idx)) & 0xFF;
+        const uint32_t shift = __builtin_ctz(masks[idx]);
+        const uint32_t range = masks[idx] >> shift;
+
+        pixel |= ((value * range + 127) / 255) << shift;
+    }
+
+    return pixel;
+
+}   // }}}
+
+static FT_Face
+open_font(FT_Library library, const xcb_screen_t* screen) noexcept
+// [Abstract]
+//   Open the font of the config. The font is matched and sized by fontconfig with the DPI of
+//   the screen as well as Xft, therefore the text looks the same as the Xlib backend.
+//
+// [Args]
+//   library (FT_Library)         : [IN] Instance of FreeType.
+//   screen  (const xcb_screen_t*): [IN] Screen of the window.
+//
+// [Returns]
+//   (FT_Face): Opened font, or nullptr if failed.
+//
+{   // {{{
+
+    const double dpi = (screen->height_in_millimeters > 0) ? (25.4 * screen->height_in_pixels / screen->height_in_millimeters) : 75.0;
+
+    FcPattern* pattern = FcPatternCreate();
+    FcPatternAddString(pattern, FC_FAMILY, reinterpret_cast<const FcChar8*>(config.xft_fontname.c_str()));
+    FcPatternAddDouble(pattern, FC_SIZE, config.xft_fontsize);
+    FcPatternAddDouble(pattern, FC_DPI, dpi);
+    FcConfigSubstitute(nullptr, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    FcResult   result;
+    FcPattern* match = FcFontMatch(nullptr, pattern, &result);
+    FcPatternDestroy(pattern);
+
+    if (match == nullptr)
+        return nullptr;
+
+    FcChar8* file  = nullptr;
+    int      index = 0;
+    double   size  = config.xft_fontsize * dpi / 72.0;
+    FcPatternGetString(match, FC_FILE, 0, &file);
+    FcPatternGetInteger(match, FC_INDEX, 0, &index);
+    FcPatternGetDouble(match, FC_PIXEL_SIZE, 0, &size);
+
+    FT_Face face = nullptr;
+    if ((file == nullptr) or (FT_New_Face(library, reinterpret_cast<const char*>(file), index, &face) != 0))
+        face = nullptr;
+
+    FcPatternDestroy(match);
+
+    if ((face != nullptr) and (FT_Set_Char_Size(face, 0, static_cast<FT_F26Dot6>(std::lround(size * 64.0)), 72, 72) != 0))
+    {
+        FT_Done_Face(face);
+        face = nullptr;
+    }
+
+    return face;
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Constructors and descructors
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+XcbBackend::XcbBackend(void)
+    : masks{0xFF0000, 0x00FF00, 0x0000FF}, swap_bytes(false),
+      buffer(static_cast<size_t>(config.window_width) * config.window_height, COLOR_VALUES[COLOR_BLACK]),
+      keymap_requested(false), keysyms_per_keycode(0), library(nullptr), face(nullptr), queued(nullptr)
+{   // {{{
+
+    // The connection setup is the only round trip before the first frame.
+    this->connection = xcb_connect(nullptr, nullptr);
+    if (xcb_connection_has_error(this->connection))
+        exit_with_message("Failed to connect to the X server");
+
+    const xcb_setup_t* setup = xcb_get_setup(this->connection);
+    this->screen = xcb_setup_roots_iterator(setup).data;
+
+    // The buffer is uploaded as the 32 bits per pixel image of the TrueColor visual, which is
+    // used by the X servers of these days.
+    bool supported = false;
+    for (auto iter = xcb_setup_pixmap_formats_iterator(setup); iter.rem; xcb_format_next(&iter))
+        if (iter.data->depth == this->screen->root_depth)
+            supported = (iter.data->bits_per_pixel == 32);
+
+    for (auto depth = xcb_screen_allowed_depths_iterator(this->screen); depth.rem; xcb_depth_next(&depth))
+        for (auto visual = xcb_depth_visuals_iterator(depth.data); visual.rem; xcb_visualtype_next(&visual))
+            if (visual.data->visual_id == this->screen->root_visual)
+            {
+                supported      = supported and (visual.data->_class == XCB_VISUAL_CLASS_TRUE_COLOR);
+                this->masks[0] = visual.data->red_mask;
+                this->masks[1] = visual.data->green_mask;
+                this->masks[2] = visual.data->blue_mask;
+            }
+
+    if ((not supported) or (this->masks[0] == 0) or (this->masks[1] == 0) or (this->masks[2] == 0))
+        exit_with_message("The visual of the X server is not supported by the XCB backend");
+
+    const uint16_t endian = 1;
+    this->swap_bytes = ((*reinterpret_cast<const uint8_t*>(&endian) == 1) != (setup->image_byte_order == XCB_IMAGE_ORDER_LSB_FIRST));
+
+    // The following requests need no reply, or their replies are received when they are used.
+    this->keymap_cookie    = xcb_get_keyboard_mapping(this->connection, setup->min_keycode, setup->max_keycode - setup->min_keycode + 1);
+    this->keymap_requested = true;
+
+    // Create the window at the center of the screen. The window background is not painted by
+    // the X server because the contents are uploaded from the buffer.
+    const uint32_t values[] = {XCB_BACK_PIXMAP_NONE, to_pixel(COLOR_VALUES[COLOR_WHITE], this->masks), XCB_EVENT_MASK_KEY_PRESS | XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_EXPOSURE};
+    const int16_t  x        = static_cast<int16_t>((this->screen->width_in_pixels  - config.window_width)  / 2);
+    const int16_t  y        = static_cast<int16_t>((this->screen->height_in_pixels - config.window_height) / 2);
+
+    this->window = xcb_generate_id(this->connection);
+    xcb_create_window(this->connection, XCB_COPY_FROM_PARENT, this->window, this->screen->root, x, y, config.window_width, config.window_height,
+                      config.window_border, XCB_WINDOW_CLASS_INPUT_OUTPUT, this->screen->root_visual, XCB_CW_BACK_PIXMAP | XCB_CW_BORDER_PIXEL | XCB_CW_EVENT_MASK, values);
+
+    // Set window size.
+    uint32_t hints[SIZE_HINTS_N_FIELDS] = {SIZE_HINTS_FLAGS, static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint32_t>(config.window_width), static_cast<uint32_t>(config.window_height)};
+    xcb_change_property(this->connection, XCB_PROP_MODE_REPLACE, this->window, XCB_ATOM_WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 32, SIZE_HINTS_N_FIELDS, hints);
+
+    const uint32_t exposures = 0;
+    this->gc = xcb_generate_id(this->connection);
+    xcb_create_gc(this->connection, this->gc, this->window, XCB_GC_GRAPHICS_EXPOSURES, &exposures);
+
+    // Let the server process the requests while the font is loaded.
+    xcb_flush(this->connection);
+
+    if ((FT_Init_FreeType(&this->library) != 0) or ((this->face = open_font(this->library, this->screen)) == nullptr))
+        exit_with_message("Failed to open the font");
+
+    const FT_Size_Metrics& metrics = this->face->size->metrics;
+    this->font_ascent      = static_cast<int32_t>((metrics.ascender + 63) >> 6);
+    this->font_descent     = static_cast<int32_t>((-metrics.descender + 63) >> 6);
+    this->font_max_advance = static_cast<int32_t>((metrics.max_advance + 63) >> 6);
+
+}   // }}}
+
+XcbBackend::~XcbBackend(void)
+{   // {{{
+
+    std::free(this->queued);
+
+    if (this->keymap_requested)
+        xcb_discard_reply(this->connection, this->keymap_cookie.sequence);
+
+    if (this->face != nullptr)
+        FT_Done_Face(this->face);
+
+    if (this->library != nullptr)
+        FT_Done_FreeType(this->library);
+
+    xcb_free_gc(this->connection, this->gc);
+    xcb_destroy_window(this->connection, this->window);
+    xcb_disconnect(this->connection);
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Member functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool
+XcbBackend::pending(void) noexcept
+{   // {{{
+
+    // Send the buffered requests (e.g. the contents drawn for the last event) before waiting for
+    // the next event as well as "XPending()".
+    if (this->queued == nullptr)
+    {
+        xcb_flush(this->connection);
+        this->queued = xcb_poll_for_event(this->connection);
+    }
+
+    return (this->queued != nullptr);
+
+}   // }}}
+
+void
+XcbBackend::next_event(BackendEvent& event) noexcept
+{   // {{{
+
+    xcb_generic_event_t* xevent = (this->queued != nullptr) ? this->queued : xcb_wait_for_event(this->connection);
+    this->queued = nullptr;
+
+    if (xevent == nullptr)
+        exit_with_message("Lost the connection to the X server");
+
+    event.type = EVENT_NONE;
+
+    switch (xevent->response_type & ~0x80)
+    {
+        case XCB_EXPOSE:
+        {
+            const xcb_expose_event_t* expose = reinterpret_cast<const xcb_expose_event_t*>(xevent);
+            event.type = EVENT_EXPOSE;
+            event.rect = {expose->x, expose->y, expose->width, expose->height};
+            break;
+        }
+
+        case XCB_KEY_PRESS:
+            event.type = EVENT_KEY;
+            event.key  = this->lookup_key(reinterpret_cast<const xcb_key_press_event_t*>(xevent)->detail);
+            break;
+
+        // Request the keyboard mapping again, which is received at the next key press.
+        case XCB_MAPPING_NOTIFY:
+        {
+            const xcb_mapping_notify_event_t* notify = reinterpret_cast<const xcb_mapping_notify_event_t*>(xevent);
+            if ((notify->request == XCB_MAPPING_KEYBOARD) and (not this->keymap_requested))
+            {
+                const xcb_setup_t* setup = xcb_get_setup(this->connection);
+                this->keymap_cookie    = xcb_get_keyboard_mapping(this->connection, setup->min_keycode, setup->max_keycode - setup->min_keycode + 1);
+                this->keymap_requested = true;
+            }
+            break;
+        }
+
+        default: break;
+    }
+
+    std::free(xevent);
+
+}   // }}}
+
+void
+XcbBackend::set_title(int32_t argc, char *argv[]) noexcept
+{   // {{{
+
+    // The same properties as "XSetWMProperties()" without the round trips of it.
+    std::string command;
+    for (int32_t idx = 0; idx < argc; ++idx)
+        command.append(argv[idx]).push_back('\0');
+
+    char hostname[256] = {};
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    xcb_change_property(this->connection, XCB_PROP_MODE_REPLACE, this->window, XCB_ATOM_WM_NAME,           XCB_ATOM_STRING, 8, config.window_title.size(), config.window_title.c_str());
+    xcb_change_property(this->connection, XCB_PROP_MODE_REPLACE, this->window, XCB_ATOM_WM_COMMAND,        XCB_ATOM_STRING, 8, command.size(),             command.c_str());
+    xcb_change_property(this->connection, XCB_PROP_MODE_REPLACE, this->window, XCB_ATOM_WM_CLIENT_MACHINE, XCB_ATOM_STRING, 8, std::strlen(hostname),      hostname);
+
+}   // }}}
+
+void
+XcbBackend::map(void) noexcept
+{   // {{{
+
+    const uint32_t above = XCB_STACK_MODE_ABOVE;
+    xcb_configure_window(this->connection, this->window, XCB_CONFIG_WINDOW_STACK_MODE, &above);
+    xcb_map_window(this->connection, this->window);
+    xcb_flush(this->connection);
+
+}   // }}}
+
+void
+XcbBackend::unmap(void) noexcept
+{   // {{{
+
+    xcb_unmap_window(this->connection, this->window);
+    xcb_flush(this->connection);
+
+}   // }}}
+
+int32_t
+XcbBackend::text_width(const char* text, const size_t size) noexcept
+{   // {{{
+
+    int32_t width = 0;
+
+    for (size_t pos = 0; pos < size;)
+        width += this->glyph(decode_utf8(text, size, pos)).advance;
+
+    return width;
+
+}   // }}}
+
+void
+XcbBackend::fill(const Rect& rect) noexcept
+{   // {{{
+
+    const int32_t x1 = std::max(rect.x, 0), x2 = std::min(rect.x + rect.width,  config.window_width);
+    const int32_t y1 = std::max(rect.y, 0), y2 = std::min(rect.y + rect.height, config.window_height);
+
+    for (int32_t y = y1; y < y2; ++y)
+        std::fill(this->buffer.begin() + y * config.window_width + x1, this->buffer.begin() + y * config.window_width + std::max(x1, x2), COLOR_VALUES[COLOR_BLACK]);
+
+}   // }}}
+
+void
+XcbBackend::draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept
+{   // {{{
+
+    const uint32_t fg  = COLOR_VALUES[color];
+    int32_t        pen = x;
+
+    for (size_t pos = 0; pos < size;)
+    {
+        const Glyph& glyph = this->glyph(decode_utf8(text, size, pos));
+
+        // Blend the glyph with the buffer by the coverage of each pixel.
+        for (int32_t row = 0; row < glyph.height; ++row)
+        {
+            const int32_t y = baseline - glyph.top + row;
+            if ((y < 0) or (y >= config.window_height))
+                continue;
+
+            for (int32_t col = 0; col < glyph.width; ++col)
+            {
+                const int32_t  px    = pen + glyph.left + col;
+                const uint32_t alpha = glyph.alpha[row * glyph.width + col];
+                if ((px < 0) or (px >= config.window_width) or (alpha == 0))
+                    continue;
+
+                uint32_t& pixel = this->buffer[y * config.window_width + px];
+                uint32_t  mixed = 0;
+
+                for (uint32_t shift = 0; shift < 24; shift += 8)
+                {
+                    const uint32_t front = (fg >> shift) & 0xFF, back = (pixel >> shift) & 0xFF;
+                    mixed |= ((front * alpha + back * (255 - alpha) + 127) / 255) << shift;
+                }
+
+                pixel = mixed;
+            }
+        }
+
+        pen += glyph.advance;
+    }
+
+}   // }}}
+
+void
+XcbBackend::present(const Rect& rect) noexcept
+{   // {{{
+
+    const int32_t x1 = std::max(rect.x, 0), x2 = std::min(rect.x + rect.width,  config.window_width);
+    const int32_t y1 = std::max(rect.y, 0), y2 = std::min(rect.y + rect.height, config.window_height);
+
+    if ((x2 <= x1) or (y2 <= y1))
+        return;
+
+    // Convert the region to the pixel format of the visual. The conversion is the identity on
+    // the common visual (0xRRGGBB in the client byte order), which is copied as is.
+    const bool    identity = (this->masks[0] == 0xFF0000) and (this->masks[1] == 0x00FF00) and (this->masks[2] == 0x0000FF) and (not this->swap_bytes);
+    const int32_t width    = x2 - x1;
+
+    this->image.resize(static_cast<size_t>(width) * (y2 - y1));
+
+    for (int32_t y = y1; y < y2; ++y)
+    {
+        const uint32_t* src = this->buffer.data() + y * config.window_width + x1;
+        uint32_t*       dst = this->image.data() + (y - y1) * width;
+
+        if (identity)
+        {
+            std::memcpy(dst, src, width * sizeof(uint32_t));
+            continue;
+        }
+
+        for (int32_t col = 0; col < width; ++col)
+        {
+            const uint32_t pixel = to_pixel(src[col], this->masks);
+            dst[col] = this->swap_bytes ? __builtin_bswap32(pixel) : pixel;
+        }
+    }
+
+    // Split the image into the bands that fit in the maximum request length of the core protocol
+    // (usually 256 KiB). BIG-REQUESTS is not used because enabling it costs a round trip.
+    const size_t  max_bytes = 4 * static_cast<size_t>(xcb_get_setup(this->connection)->maximum_request_length) - PUT_IMAGE_HEADER;
+    const int32_t band      = std::max<int32_t>(max_bytes / (width * sizeof(uint32_t)), 1);
+
+    for (int32_t y = y1; y < y2; y += band)
+    {
+        const int32_t rows = std::min(band, y2 - y);
+        xcb_put_image(this->connection, XCB_IMAGE_FORMAT_Z_PIXMAP, this->window, this->gc, width, rows, x1, y, 0, this->screen->root_depth,
+                      rows * width * sizeof(uint32_t), reinterpret_cast<const uint8_t*>(this->image.data() + (y - y1) * width));
+    }
+
+}   // }}}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Private functions
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+const XcbBackend::Glyph&
+XcbBackend::glyph(const uint32_t code) noexcept
+{   // {{{
+
+    const auto iter = this->glyphs.find(code);
+    if (iter != this->glyphs.end())
+        return iter->second;
+
+    Glyph glyph = {0, 0, 0, 0, 0, {}};
+
+    if (FT_Load_Char(this->face, code, FT_LOAD_RENDER | FT_LOAD_TARGET_LIGHT) == 0)
+    {
+        const FT_GlyphSlot slot   = this->face->glyph;
+        const FT_Bitmap&   bitmap = slot->bitmap;
+
+        glyph.left    = slot->bitmap_left;
+        glyph.top     = slot->bitmap_top;
+        glyph.width   = static_cast<int32_t>(bitmap.width);
+        glyph.height  = static_cast<int32_t>(bitmap.rows);
+        glyph.advance = static_cast<int32_t>((slot->advance.x + 32) >> 6);
+        glyph.alpha.resize(static_cast<size_t>(glyph.width) * glyph.height);
+
+        // The bitmap fonts are rendered in monochrome.
+        for (int32_t row = 0; row < glyph.height; ++row)
+        {
+            const uint8_t* line = bitmap.buffer + row * bitmap.pitch;
+
+            for (int32_t col = 0; col < glyph.width; ++col)
+            {
+                if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) glyph.alpha[row * glyph.width + col] = (line[col / 8] & (0x80 >> (col % 8))) ? 255 : 0;
+                else                                         glyph.alpha[row * glyph.width + col] = line[col];
+            }
+        }
+    }
+
+    return this->glyphs.emplace(code, std::move(glyph)).first->second;
+
+}   // }}}
+
+char
+XcbBackend::lookup_key(const xcb_keycode_t keycode) noexcept
+{   // {{{
+
+    if (this->keymap_requested)
+    {
+        this->keymap_requested = false;
+
+        xcb_get_keyboard_mapping_reply_t* reply = xcb_get_keyboard_mapping_reply(this->connection, this->keymap_cookie, nullptr);
+        if (reply != nullptr)
+        {
+            const xcb_keysym_t* keysyms = xcb_get_keyboard_mapping_keysyms(reply);
+            this->keysyms.assign(keysyms, keysyms + xcb_get_keyboard_mapping_keysyms_length(reply));
+            this->keysyms_per_keycode = reply->keysyms_per_keycode;
+            std::free(reply);
+        }
+    }
+
+    const size_t index = static_cast<size_t>(keycode - xcb_get_setup(this->connection)->min_keycode) * this->keysyms_per_keycode;
+    return (index < this->keysyms.size()) ? static_cast<char>(this->keysyms[index]) : 0;
+
+}   // }}}
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker
@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/// C++ header file: xcb.hxx                                                                     ///
+///                                                                                              ///
+/// This file provides the "XcbBackend" class, the backend of the main window for the X server   ///
+/// on XCB. The requests of the startup are sent without waiting for any reply, and the text is  ///
+/// rendered on the client by FreeType with the font matched by fontconfig as well as Xft.       ///
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef XCB_HXX
+#define XCB_HXX
+
+// Include the headers of STL.
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Include XCB and FreeType headers.
+#include <xcb/xcb.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+
+// Include custom headers.
+#include "backend.hxx"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Class definition
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class XcbBackend : public Backend
+{
+    public:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Constructors and descructors
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+         XcbBackend(void);
+        ~XcbBackend(void);
+        // [Abstract]
+        //   Connect to the X server and create the window. The requests are flushed before the
+        //   font is loaded, so that the server processes them while the client reads the font.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Member functions (see "backend.hxx")
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        int32_t
+        fd(void) const noexcept override { return xcb_get_file_descriptor(this->connection); }
+
+        bool
+        pending(void) noexcept override;
+
+        void
+        next_event(BackendEvent& event) noexcept override;
+
+        void
+        set_title(int32_t argc, char *argv[]) noexcept override;
+
+        void
+        map(void) noexcept override;
+
+        void
+        unmap(void) noexcept override;
+
+        void
+        flush(void) noexcept override { xcb_flush(this->connection); }
+
+        int32_t
+        ascent(void) const noexcept override { return this->font_ascent; }
+
+        int32_t
+        descent(void) const noexcept override { return this->font_descent; }
+
+        int32_t
+        max_advance(void) const noexcept override { return this->font_max_advance; }
+
+        int32_t
+        text_width(const char* text, const size_t size) noexcept override;
+
+        void
+        fill(const Rect& rect) noexcept override;
+
+        void
+        draw_text(const int32_t color, const int32_t x, const int32_t baseline, const char* text, const size_t size) noexcept override;
+
+        void
+        present(const Rect& rect) noexcept override;
+
+    private:
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private data types
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        typedef struct {
+            int32_t              left;     // Horizontal offset of the bitmap from the pen position.
+            int32_t              top;      // Height of the bitmap above the baseline.
+            int32_t              width;    // Width of the bitmap.
+            int32_t              height;   // Height of the bitmap.
+            int32_t              advance;  // Advance width in pixels.
+            std::vector<uint8_t> alpha;    // Coverage of each pixel (width x height).
+        } Glyph;
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private member variables
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        xcb_connection_t* connection;
+        // Connection to the X server.
+
+        xcb_screen_t* screen;
+        // Default screen of the connection.
+
+        xcb_window_t window;
+        // Window instance.
+
+        xcb_gcontext_t gc;
+        // Graphics context used for uploading the buffer to the window.
+
+        uint32_t masks[3];
+        // Red, green and blue masks of the visual of the window.
+
+        bool swap_bytes;
+        // True if the byte order of the images differs from the client.
+
+        std::vector<uint32_t> buffer;
+        // Off-screen buffer on the client (0xRRGGBB). The damaged region is uploaded to the window.
+
+        std::vector<uint32_t> image;
+        // Pixels of the damaged region in the format of the visual, reused for each upload.
+
+        xcb_get_keyboard_mapping_cookie_t keymap_cookie;
+        // Request of the keyboard mapping whose reply is not received yet.
+
+        bool keymap_requested;
+        // True if the reply of "this->keymap_cookie" is not received yet.
+
+        std::vector<xcb_keysym_t> keysyms;
+        // Keysyms of each keycode.
+
+        uint8_t keysyms_per_keycode;
+        // Number of the keysyms per keycode in "this->keysyms".
+
+        FT_Library library;
+        // Instance of FreeType.
+
+        FT_Face face;
+        // Font face matched to the config.
+
+        std::unordered_map<uint32_t, Glyph> glyphs;
+        // Rendered glyphs indexed by the code point.
+
+        int32_t font_ascent;
+        // Ascent of the font in pixels.
+
+        int32_t font_descent;
+        // Descent of the font in pixels.
+
+        int32_t font_max_advance;
+        // Maximum advance width of the glyphs in pixels.
+
+        xcb_generic_event_t* queued;
+        // Event read by "pending()" and not returned by "next_event()" yet, or nullptr.
+
+        ////////////////////////////////////////////////////////////////////////////////////////////
+        // Private functions
+        ////////////////////////////////////////////////////////////////////////////////////////////
+
+        const Glyph&
+        glyph(const uint32_t code) noexcept;
+        // [Abstract]
+        //   Returns the glyph of the given code point, which is rendered at the first use.
+        //
+        // [Args]
+        //   code (const uint32_t): [IN] Unicode code point.
+        //
+        // [Returns]
+        //   (const Glyph&): Rendered glyph (empty if the font does not have it).
+
+        char
+        lookup_key(const xcb_keycode_t keycode) noexcept;
+        // [Abstract]
+        //   Returns the first keysym of the given keycode as well as "XLookupKeysym(event, 0)".
+        //   The reply of the keyboard mapping is received here at the first key press.
+        //
+        // [Args]
+        //   keycode (const xcb_keycode_t): [IN] Keycode of the key event.
+        //
+        // [Returns]
+        //   (char): Lower 8 bits of the keysym.
+};
+
+#endif
+
+// vim: expandtab shiftwidth=4 shiftwidth=4 fdm=marker